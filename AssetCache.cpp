@@ -0,0 +1,250 @@
+#include "AssetCache.hpp"
+#include "data_path.hpp"
+#include "Jobs.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	uint64_t hash_stream(std::istream &file, std::string const &filename) {
+		if (!file) {
+			throw std::runtime_error("Failed to open '" + filename + "' for hashing.");
+		}
+		uint64_t hash = 0xcbf29ce484222325ULL; //FNV-1a offset basis
+		std::vector< char > block(1 << 16);
+		while (file) {
+			file.read(block.data(), block.size());
+			std::streamsize got = file.gcount();
+			for (std::streamsize i = 0; i < got; ++i) {
+				hash = (hash ^ uint8_t(block[i])) * 0x100000001b3ULL; //FNV-1a prime
+			}
+		}
+		return hash;
+	}
+}
+
+uint64_t AssetCache::hash_file(std::string const &filename) {
+	std::unique_ptr< std::istream > file = open_data(filename); //(may come from a mounted bundle)
+	return hash_stream(*file, filename);
+}
+
+uint64_t AssetCache::hash_loose_file(std::string const &filename) {
+	std::ifstream file(filename, std::ios::binary);
+	return hash_stream(file, filename);
+}
+
+//------------ content-keyed sharing ------------
+
+namespace {
+	std::mutex cache_mutex;
+	std::map< std::pair< std::type_index, uint64_t >, void const * > &get_cache() {
+		static std::map< std::pair< std::type_index, uint64_t >, void const * > cache;
+		return cache;
+	}
+}
+
+void const *AssetCache::find(std::type_index type, uint64_t hash) {
+	std::unique_lock< std::mutex > lock(cache_mutex);
+	auto &cache = get_cache();
+	auto f = cache.find(std::make_pair(type, hash));
+	return (f == cache.end() ? nullptr : f->second);
+}
+
+void const *AssetCache::store(std::type_index type, uint64_t hash, void const *asset, void (*destroy)(void const *)) {
+	void const *stored;
+	{
+		std::unique_lock< std::mutex > lock(cache_mutex);
+		stored = get_cache().insert(std::make_pair(std::make_pair(type, hash), asset)).first->second;
+	}
+	//if another thread stored an identical asset first, that one wins and the duplicate is freed:
+	if (stored != asset) destroy(asset);
+	return stored;
+}
+
+//------------ hot-reloading ------------
+
+namespace {
+	struct Watcher {
+		struct Watch {
+			uint64_t hash = 0; //contents when last (re)loaded; 0 if file couldn't be read
+			int64_t mtime = 0; //modification time, for polling
+			std::vector< std::function< std::function< void() >() > > on_change;
+		};
+
+		std::mutex mutex; //protects everything below
+		std::map< std::string, Watch > watches;
+
+		std::thread thread;
+		std::atomic< bool > quit{false};
+
+		#if defined(__linux__)
+		int inotify_fd = -1;
+		std::map< int, std::string > watched_dirs; //watch descriptor -> directory
+		#endif
+
+		~Watcher() {
+			if (thread.joinable()) {
+				quit = true;
+				thread.join();
+			}
+			#if defined(__linux__)
+			if (inotify_fd != -1) close(inotify_fd);
+			#endif
+		}
+
+		static int64_t get_mtime(std::string const &filename) {
+			struct stat info;
+			if (stat(filename.c_str(), &info) != 0) return 0;
+			return int64_t(info.st_mtime);
+		}
+
+		//(called on the watcher thread) re-hash changed files and run their callbacks:
+		void check(std::set< std::string > const &filenames) {
+			for (auto const &filename : filenames) {
+				std::vector< std::function< std::function< void() >() > > on_change;
+				{
+					std::unique_lock< std::mutex > lock(mutex);
+					auto f = watches.find(filename);
+					if (f == watches.end()) continue;
+					uint64_t hash = 0;
+					try {
+						hash = AssetCache::hash_loose_file(filename);
+					} catch (std::exception &) {
+						continue; //file is probably mid-write (or was deleted); wait for next change
+					}
+					if (hash == f->second.hash) continue; //touched, but contents didn't change
+					f->second.hash = hash;
+					on_change = f->second.on_change;
+				}
+				//the edited file now takes precedence over any mounted bundle's copy:
+				unbundle(filename);
+				std::cout << "Reloading '" << filename << "'..." << std::endl;
+				for (auto const &fn : on_change) {
+					try {
+						std::function< void() > finish = fn();
+						if (finish) {
+							//(the main lane runs in order, so loads still finish in the order they were registered)
+							Jobs::run_on_main([finish,filename](){
+								try {
+									finish();
+								} catch (std::exception &e) {
+									std::cerr << "WARNING: failed to finish reloading '" << filename << "': " << e.what() << std::endl;
+								}
+							});
+						}
+					} catch (std::exception &e) {
+						std::cerr << "WARNING: failed to reload '" << filename << "': " << e.what() << std::endl;
+					}
+				}
+			}
+		}
+
+		void run() {
+			while (!quit) {
+				std::set< std::string > changed;
+
+				#if defined(__linux__)
+				pollfd pfd;
+				pfd.fd = inotify_fd;
+				pfd.events = POLLIN;
+				if (poll(&pfd, 1, 250) <= 0) continue;
+				//give editors a moment to finish writing (and collect any follow-up events):
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				alignas(inotify_event) char buffer[4096];
+				ssize_t got;
+				while ((got = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+					for (char *at = buffer; at < buffer + got; ) {
+						inotify_event const *event = reinterpret_cast< inotify_event const * >(at);
+						if (event->len > 0) {
+							std::unique_lock< std::mutex > lock(mutex);
+							auto d = watched_dirs.find(event->wd);
+							if (d != watched_dirs.end()) {
+								changed.insert(d->second + "/" + event->name);
+							}
+						}
+						at += sizeof(inotify_event) + event->len;
+					}
+				}
+				#else
+				std::this_thread::sleep_for(std::chrono::milliseconds(250));
+				{ //poll modification times:
+					std::unique_lock< std::mutex > lock(mutex);
+					for (auto &w : watches) {
+						int64_t mtime = get_mtime(w.first);
+						if (mtime != w.second.mtime) {
+							w.second.mtime = mtime;
+							changed.insert(w.first);
+						}
+					}
+				}
+				#endif
+
+				check(changed);
+			}
+		}
+
+		void add(std::string const &filename, std::function< std::function< void() >() > const &on_change) {
+			std::unique_lock< std::mutex > lock(mutex);
+
+			auto f = watches.find(filename);
+			if (f == watches.end()) {
+				f = watches.insert(std::make_pair(filename, Watch())).first;
+				try {
+					f->second.hash = AssetCache::hash_loose_file(filename);
+				} catch (std::exception &) {
+					f->second.hash = 0;
+				}
+				f->second.mtime = get_mtime(filename);
+
+				#if defined(__linux__)
+				if (inotify_fd == -1) {
+					inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+					if (inotify_fd == -1) {
+						std::cerr << "WARNING: failed to initialize inotify; hot-reloading disabled." << std::endl;
+					}
+				}
+				std::string dir = filename.substr(0, filename.rfind('/'));
+				if (inotify_fd != -1) {
+					//(adding a watch on an already-watched directory returns the existing descriptor)
+					int wd = inotify_add_watch(inotify_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+					if (wd == -1) {
+						std::cerr << "WARNING: failed to watch '" << dir << "' for changes." << std::endl;
+					} else {
+						watched_dirs[wd] = dir;
+					}
+				}
+				#endif
+			}
+			f->second.on_change.emplace_back(on_change);
+
+			if (!thread.joinable()) {
+				thread = std::thread([this](){ run(); });
+			}
+		}
+	};
+
+	Watcher &get_watcher() {
+		static Watcher watcher;
+		return watcher;
+	}
+}
+
+void AssetCache::watch(std::string const &filename, std::function< std::function< void() >() > const &on_change) {
+	get_watcher().add(filename, on_change);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+/*
+ * AssetCache helps with two things:
+ *
+ * (1) Sharing: AssetCache::load< T >(filename) keys loaded assets by a hash of their file's contents,
+ *     so two files with identical contents are only loaded (decoded, parsed, ...) once.
+ *
+ * (2) Hot-reloading: AssetCache::watch(filename, on_change) calls 'on_change' on a background
+ *     thread whenever the contents of 'filename' change. Like a LoadJob (see Load.hpp), it returns
+ *     a function that is queued for the main thread with Jobs::run_on_main(); the main loop runs
+ *     those between frames (Jobs::run_main_jobs) -- so new assets are swapped in all at once, never mid-frame.
+ *     (Load< T >::reload_on_change() builds on this.)
+ *     Watched files are read from disk; once one changes it is unbundle()'d (see data_path.hpp),
+ *     so the edited file is loaded even when an asset bundle is mounted.
+ *
+ * Changes are detected with inotify on linux, and by polling file modification times elsewhere.
+ *
+ */
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <typeindex>
+
+namespace AssetCache {
+
+//64-bit FNV-1a hash of the contents of a file (as open_data() reads it -- i.e., possibly from a mounted bundle):
+// note: will throw if file cannot be read.
+uint64_t hash_file(std::string const &filename);
+
+//...of the file on disk, ignoring any mounted bundle (this is what watch() looks at):
+uint64_t hash_loose_file(std::string const &filename);
+
+//look up / store a loaded asset by type and content hash (used by load<>, below):
+// store() returns the already-stored asset if another thread got there first (and frees 'asset' with 'destroy').
+void const *find(std::type_index type, uint64_t hash);
+void const *store(std::type_index type, uint64_t hash, void const *asset, void (*destroy)(void const *));
+
+//Load a T by calling 'load_fn' on 'filename', unless a file with identical contents was already loaded as a T:
+// (may be called from loading threads)
+// 'salt' is mixed into the key -- pass something that identifies anything else 'load_fn' depends on (e.g., other assets it refers to)
+template< typename T >
+T const *load(std::string const &filename, std::function< T const *(std::string const &) > const &load_fn, uint64_t salt = 0) {
+	uint64_t hash = hash_file(filename) ^ (salt * 0x9e3779b97f4a7c15ULL);
+	if (void const *found = find(typeid(T), hash)) {
+		return static_cast< T const * >(found);
+	}
+	return static_cast< T const * >(store(typeid(T), hash, load_fn(filename), [](void const *asset){
+		delete static_cast< T const * >(asset);
+	}));
+}
+
+//...for the common case of T having a constructor that takes a filename:
+template< typename T >
+T const *load(std::string const &filename) {
+	return load< T >(filename, [](std::string const &path) -> T const * { return new T(path); });
+}
+
+//Call 'on_change' (on a background thread) whenever the contents of 'filename' change:
+// 'on_change' returns a (possibly empty) function to be run on the main thread (see Jobs::run_on_main).
+// multiple callbacks for the same file are called in the order they were added.
+void watch(std::string const &filename, std::function< std::function< void() >() > const &on_change);
+
+} //namespace AssetCache
@@ -0,0 +1,123 @@
+#include "Bundle.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Bundle::Bundle(std::string const &filename_) : filename(filename_) {
+	//------ map (or, failing that, read) the whole file ------
+	#if defined(_WIN32)
+	file_handle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file_handle == INVALID_HANDLE_VALUE) {
+		file_handle = nullptr;
+		throw std::runtime_error("Failed to open bundle '" + filename + "'.");
+	}
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(file_handle, &size)) {
+		mapped_size = uint64_t(size.QuadPart);
+		if (mapped_size != 0) mapping_handle = CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping_handle) mapped = reinterpret_cast< char const * >(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+	}
+	#else
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd == -1) {
+		throw std::runtime_error("Failed to open bundle '" + filename + "'.");
+	}
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size > 0) {
+		mapped_size = uint64_t(info.st_size);
+		void *ptr = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (ptr != MAP_FAILED) mapped = reinterpret_cast< char const * >(ptr);
+	}
+	close(fd); //(mapping stays valid after close)
+	#endif
+
+	if (!mapped) {
+		std::cerr << "WARNING: failed to map bundle '" << filename << "' into memory; reading it instead." << std::endl;
+		std::ifstream file(filename, std::ios::binary);
+		read_data.assign(std::istreambuf_iterator< char >(file), std::istreambuf_iterator< char >());
+		mapped = read_data.data();
+		mapped_size = read_data.size();
+	}
+
+	//------ read the index ------
+	// (if this throws, the destructor won't run -- so release the mapping here)
+	try {
+		read_index();
+	} catch (...) {
+		unmap();
+		throw;
+	}
+}
+
+void Bundle::read_index() {
+	auto fail = [this](std::string const &why) {
+		throw std::runtime_error("Bundle '" + filename + "' is corrupt (" + why + ").");
+	};
+
+	if (mapped_size < sizeof(Header)) fail("too small for header");
+	Header header;
+	std::memcpy(&header, mapped, sizeof(Header));
+	if (std::string(header.magic, 4) != "bnd0") fail("wrong magic");
+
+	uint64_t names_at = sizeof(Header) + uint64_t(header.count) * sizeof(IndexEntry);
+	if (names_at + header.names_size > mapped_size) fail("index runs past end of file");
+	char const *names = mapped + names_at;
+
+	files.reserve(header.count);
+	for (uint32_t i = 0; i < header.count; ++i) {
+		IndexEntry entry;
+		std::memcpy(&entry, mapped + sizeof(Header) + i * sizeof(IndexEntry), sizeof(IndexEntry));
+		if (!(entry.name_begin <= entry.name_end && entry.name_end <= header.names_size)) fail("bad name range");
+		if (!(entry.offset <= mapped_size && entry.size <= mapped_size - entry.offset)) fail("bad data range");
+
+		files.emplace_back();
+		files.back().name = std::string(names + entry.name_begin, names + entry.name_end);
+		files.back().data = mapped + entry.offset;
+		files.back().size = entry.size;
+		if (i > 0 && !(files[i-1].name < files[i].name)) fail("index not sorted");
+	}
+}
+
+Bundle::~Bundle() {
+	unmap();
+}
+
+void Bundle::unmap() {
+	if (read_data.empty() && mapped) {
+		#if defined(_WIN32)
+		UnmapViewOfFile(mapped);
+		#else
+		munmap(const_cast< char * >(mapped), mapped_size);
+		#endif
+	}
+	mapped = nullptr;
+	mapped_size = 0;
+	read_data.clear();
+	files.clear();
+	#if defined(_WIN32)
+	if (mapping_handle) CloseHandle(mapping_handle);
+	mapping_handle = nullptr;
+	if (file_handle) CloseHandle(file_handle);
+	file_handle = nullptr;
+	#endif
+}
+
+Bundle::File const *Bundle::find(std::string const &name) const {
+	auto f = std::lower_bound(files.begin(), files.end(), name, [](File const &file, std::string const &n) {
+		return file.name < n;
+	});
+	if (f == files.end() || f->name != name) return nullptr;
+	return &*f;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+/*
+ * A Bundle is a single file holding many data files, so that loading
+ * doesn't need to open (and seek around in) dozens of separate files.
+ *
+ * Bundles are built with the 'asset-bundle' command-line tool (see asset-bundle.cpp), and
+ * are mapped into memory (mmap / MapViewOfFile) when opened, so that reading
+ * an asset out of a bundle costs only the page faults needed to touch it.
+ *
+ * Usually you won't use a Bundle directly; instead, mount it with
+ * mount_bundle() (see data_path.hpp) and open files with open_data().
+ *
+ * File format:
+ * |bn|d0|..|..| <-- header: "bnd0" magic, (uint32) entry count, (uint32) names size, (uint32) reserved
+ * |EE...EE| * count <-- index entries: (uint64) offset, (uint64) size, (uint32) name_begin, (uint32) name_end
+ * |nn...nn| <-- names, referenced by [name_begin,name_end) ranges in the index
+ * ...then the contents of every file, each starting on a PageSize boundary.
+ *
+ * Index entries are sorted by name. All values are native-endian.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct Bundle {
+	//Open + map a bundle file:
+	// note: will throw on error
+	Bundle(std::string const &filename);
+	~Bundle();
+	Bundle(Bundle const &) = delete;
+	Bundle &operator=(Bundle const &) = delete;
+
+	//file data is aligned to this many bytes:
+	static constexpr uint64_t PageSize = 4096;
+
+	struct Header {
+		char magic[4] = {'b','n','d','0'};
+		uint32_t count = 0;
+		uint32_t names_size = 0;
+		uint32_t reserved = 0;
+	};
+	static_assert(sizeof(Header) == 4 + 4 + 4 + 4, "Bundle::Header is packed.");
+
+	struct IndexEntry {
+		uint64_t offset = 0;
+		uint64_t size = 0;
+		uint32_t name_begin = 0;
+		uint32_t name_end = 0;
+	};
+	static_assert(sizeof(IndexEntry) == 8 + 8 + 4 + 4, "Bundle::IndexEntry is packed.");
+
+	//A file in the bundle (data points into the mapped bundle):
+	struct File {
+		std::string name;
+		char const *data = nullptr;
+		uint64_t size = 0;
+	};
+
+	//Look up a file by name:
+	// returns nullptr if not found.
+	File const *find(std::string const &name) const;
+
+	std::string filename;
+	std::vector< File > files; //sorted by name
+
+	//---- internals ----
+	void read_index(); //fill in 'files' from the mapped index (throws if it's corrupt)
+	void unmap(); //release the mapping (and handles)
+	char const *mapped = nullptr;
+	uint64_t mapped_size = 0;
+	std::vector< char > read_data; //holds bundle contents if mapping wasn't possible
+	#if defined(_WIN32)
+	void *file_handle = nullptr;
+	void *mapping_handle = nullptr;
+	#endif
+};
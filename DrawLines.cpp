@@ -1,24 +1,23 @@
 #include "DrawLines.hpp"
 #include "PathFont.hpp"
 #include "ColorProgram.hpp"
+#include "StreamBuffer.hpp"
+#include "Profiler.hpp"
+#include "FrameArena.hpp"
 
 #include "gl_errors.hpp"
 
 #include <glm/gtc/type_ptr.hpp>
 
-//All DrawLines instances share a vertex array object and vertex buffer, initialized at load time:
+//All DrawLines instances share a vertex array object (reading from the shared immediate_stream() buffer), initialized at load time:
 
 //n.b. declared static so they don't conflict with similarly named global variables elsewhere:
-static GLuint vertex_buffer = 0;
 static GLuint vertex_buffer_for_color_program = 0;
 
 static Load< void > setup_buffers(LoadTagDefault, [](){
 	//you may recognize this init code from DrawSprites.cpp:
 
-	{ //set up vertex buffer:
-		glGenBuffers(1, &vertex_buffer);
-		//for now, buffer will be un-filled.
-	}
+	GLuint vertex_buffer = immediate_stream().buffer;
 
 	{ //vertex array mapping buffer for color_program:
 		//ask OpenGL to fill vertex_buffer_for_color_program with the name of an unused vertex array object:
@@ -64,6 +63,7 @@ static Load< void > setup_buffers(LoadTagDefault, [](){
 
 
 DrawLines::DrawLines(glm::mat4 const &world_to_clip_) : world_to_clip(world_to_clip_) {
+	attribs.reserve(256); //(arena memory is cheap; this skips the first few rounds of re-growing)
 }
 
 void DrawLines::draw(glm::vec3 const &a, glm::vec3 const &b, glm::u8vec4 const &color) {
@@ -90,46 +90,18 @@ void DrawLines::draw_box(glm::mat4x3 const &mat, glm::u8vec4 const &color) {
 	draw(mat * glm::vec4( 1.0f, 1.0f,-1.0f, 1.0f), mat * glm::vec4( 1.0f, 1.0f, 1.0f, 1.0f), color);
 }
 
-void DrawLines::draw_text(std::string const &text, glm::vec3 const &anchor_in, glm::vec3 const &x, glm::vec3 const &y, glm::u8vec4 const &color, glm::vec3 *anchor_out) {
-
-	glm::vec3 anchor = anchor_in;
-
-	uint32_t start = 0;
-	while (start < text.size()) {
-		uint32_t end = start;
-		uint32_t glyph = -1U;
-		while (end < text.size()) {
-			end += 1;
-			auto f = PathFont::font.glyph_map.find(text.substr(start, end-start));
-			if (f == PathFont::font.glyph_map.end()) {
-				end -= 1;
-				break;
-			}
-			glyph = f->second;
-		}
-		if (glyph == -1U) {
-			assert(start == end);
-			end += 1;
-			//missing! draw a tofu:
-			for (const auto &pt : {
-				glm::vec2(0.1f, 0.1f), glm::vec2(0.6f, 0.1f),
-				glm::vec2(0.6f, 0.1f), glm::vec2(0.6f, 0.9f),
-				glm::vec2(0.9f, 0.6f), glm::vec2(0.1f, 0.9f),
-				glm::vec2(0.1f, 0.9f), glm::vec2(0.1f, 0.1f)
-			}) {
-				attribs.emplace_back(anchor + pt.x * x + pt.y * y, color);
-			}
-			anchor += x * 0.6f;
-		} else {
-			for (uint32_t c = PathFont::font.glyph_coord_starts[glyph]; c + 1 < PathFont::font.glyph_coord_starts[glyph+1]; c += 2) {
-				attribs.emplace_back(anchor + x * PathFont::font.coords[c] + y * PathFont::font.coords[c+1], color);
-			}
-			anchor += x * PathFont::font.glyph_widths[glyph];
-		}
-		start = end;
+void DrawLines::draw_text(std::string_view text, glm::vec3 const &anchor_in, glm::vec3 const &x, glm::vec3 const &y, glm::u8vec4 const &color, glm::vec3 *anchor_out) {
+
+	//lay out in glyph space, then place along x/y:
+	// (scratch array comes from the frame arena, so drawing text doesn't allocate every frame)
+	frame_vector< glm::vec2 > lines;
+	float advance = PathFont::font.layout(text, &lines);
+
+	for (auto const &pt : lines) {
+		attribs.emplace_back(anchor_in + pt.x * x + pt.y * y, color);
 	}
 
-	if (anchor_out) *anchor_out = anchor;
+	if (anchor_out) *anchor_out = anchor_in + advance * x;
 }
 
 DrawLines::~DrawLines() {
@@ -137,10 +109,9 @@ DrawLines::~DrawLines() {
 
 	//based on DrawSprites.cpp :
 
-	//upload vertices to vertex_buffer:
-	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer); //set vertex_buffer as current
-	glBufferData(GL_ARRAY_BUFFER, attribs.size() * sizeof(attribs[0]), attribs.data(), GL_STREAM_DRAW); //upload attribs array
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	//upload vertices to the shared stream buffer:
+	GLintptr offset = immediate_stream().write(attribs.data(), attribs.size() * sizeof(attribs[0]), sizeof(attribs[0]));
+	GLint first = GLint(offset / sizeof(attribs[0]));
 
 	//set color_program as current program:
 	glUseProgram(color_program->program);
@@ -152,7 +123,8 @@ DrawLines::~DrawLines() {
 	glBindVertexArray(vertex_buffer_for_color_program);
 
 	//run the OpenGL pipeline:
-	glDrawArrays(GL_LINES, 0, GLsizei(attribs.size()));
+	glDrawArrays(GL_LINES, first, GLsizei(attribs.size()));
+	Profiler::count_draw_call();
 
 	//reset vertex array to none:
 	glBindVertexArray(0);
@@ -6,13 +6,19 @@
  *
  * Similar usage pattern to DrawSprites.
  *
+ * Vertices are collected in frame arena memory (see FrameArena.hpp) and uploaded
+ * through the shared immediate_stream() (see StreamBuffer.hpp), so a DrawLines per
+ * frame doesn't touch the heap once things have warmed up.
+ *
  */
 
 
+#include "FrameArena.hpp"
+
 #include <glm/glm.hpp>
 
 #include <string>
-#include <vector>
+#include <string_view>
 
 struct DrawLines {
 	//Start drawing; will remember world_to_clip matrix:
@@ -25,8 +31,8 @@ struct DrawLines {
 	void draw_box(glm::mat4x3 const &mat, glm::u8vec4 const &color = glm::u8vec4(0xff));
 
 	//draw wireframe text, start at anchor, move in x direction, mat gives x and y directions for text drawing:
-	// (default character box is 1 unit high)
-	void draw_text(std::string const &text,
+	// (default character box is 1 unit high; 'text' may be a std::string or a per-frame frame_string)
+	void draw_text(std::string_view text,
 		glm::vec3 const &anchor,
 		glm::vec3 const &x = glm::vec3(1.0f, 0.0f, 0.0f),
 		glm::vec3 const &y = glm::vec3(0.0f, 1.0f, 1.0f),
@@ -43,6 +49,6 @@ struct DrawLines {
 		glm::vec3 Position;
 		glm::u8vec4 Color;
 	};
-	std::vector< Vertex > attribs;
+	frame_vector< Vertex > attribs; //(so DrawLines should not outlive the frame it was created in)
 
 };
@@ -0,0 +1,121 @@
+#include "FrameArena.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+namespace {
+	struct Block {
+		char *data = nullptr;
+		size_t size = 0;
+	};
+
+	struct Arena {
+		Block current; //block being allocated from
+		size_t at = 0; //next free byte in 'current'
+		std::vector< Block > full; //blocks that filled up this frame (freed at reset)
+		size_t full_bytes = 0; //total size of 'full'
+		size_t used = 0; //bytes allocated since reset (including alignment padding)
+
+		~Arena() {
+			std::free(current.data);
+			for (auto &block : full) std::free(block.data);
+		}
+	};
+
+	Arena &arena() {
+		static Arena arena;
+		return arena;
+	}
+
+	constexpr size_t MinBlockSize = size_t(1) << 16;
+
+	Block new_block(size_t size) {
+		Block block;
+		block.size = std::max(size, MinBlockSize);
+		block.data = static_cast< char * >(std::malloc(block.size));
+		if (!block.data) throw std::bad_alloc();
+		return block;
+	}
+
+	std::atomic< uint64_t > heap_allocation_count{0};
+}
+
+void *FrameArena::allocate(size_t size, size_t alignment) {
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+	Arena &a = arena();
+
+	size_t start = (a.at + alignment - 1) & ~(alignment - 1);
+	if (a.current.data == nullptr || start + size > a.current.size) {
+		//out of room; retire this block and start a bigger one:
+		if (a.current.data) {
+			a.full.emplace_back(a.current);
+			a.full_bytes += a.current.size;
+		}
+		a.current = new_block(std::max(size + alignment, 2 * a.current.size));
+		a.at = 0;
+		start = (reinterpret_cast< uintptr_t >(a.current.data) + alignment - 1) / alignment * alignment - reinterpret_cast< uintptr_t >(a.current.data);
+	}
+
+	a.used += (start - a.at) + size;
+	a.at = start + size;
+	return a.current.data + start;
+}
+
+void FrameArena::reset() {
+	Arena &a = arena();
+	if (!a.full.empty()) {
+		//the frame needed more than one block, so replace them all with a block that holds everything:
+		size_t total = a.full_bytes + a.current.size;
+		for (auto &block : a.full) std::free(block.data);
+		a.full.clear();
+		a.full_bytes = 0;
+		std::free(a.current.data);
+		a.current = new_block(total);
+	}
+	a.at = 0;
+	a.used = 0;
+}
+
+size_t FrameArena::used() {
+	return arena().used;
+}
+
+size_t FrameArena::capacity() {
+	return arena().current.size;
+}
+
+uint64_t FrameArena::heap_allocations() {
+	return heap_allocation_count.load(std::memory_order_relaxed);
+}
+
+//------ counting replacements for global operator new/delete ------
+// (the nothrow forms forward to these; over-aligned allocations aren't counted)
+
+void *operator new(std::size_t size) {
+	heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if (void *ptr = std::malloc(size ? size : 1)) return ptr;
+	throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+/*
+ * FrameArena is a bump allocator for data that only lives until the end of the
+ * frame (vertex lists, scratch arrays, formatted strings, ...):
+ *
+ *   frame_vector< glm::vec3 > points; //allocates from the arena; nothing to free
+ *
+ * Allocating is just moving a pointer; FrameArena::reset() (called by main.cpp
+ * at the end of every frame) makes the whole arena available again. If a frame
+ * needs more space than the arena has, extra blocks are allocated from the heap
+ * and, at the next reset(), replaced with one block big enough for everything --
+ * so in steady state the arena never touches the heap.
+ *
+ * Use only from the main thread, and never keep arena memory past the end of the frame.
+ *
+ * Also counts heap allocations (by replacing global operator new), so the
+ * profiler can show how many allocations each frame makes.
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace FrameArena {
+
+//Get 'size' bytes, aligned to 'alignment' (a power of two):
+void *allocate(size_t size, size_t alignment);
+
+//Release everything allocated since the last reset (call once per frame):
+void reset();
+
+//Arena usage:
+size_t used(); //bytes allocated since last reset
+size_t capacity(); //bytes available without touching the heap
+
+//Heap allocations (calls to operator new) since program start, from any thread:
+uint64_t heap_allocations();
+
+} //namespace FrameArena
+
+//STL-compatible allocator that allocates from the frame arena:
+template< typename T >
+struct FrameAllocator {
+	using value_type = T;
+
+	FrameAllocator() = default;
+	template< typename U >
+	FrameAllocator(FrameAllocator< U > const &) { }
+
+	T *allocate(size_t n) {
+		return static_cast< T * >(FrameArena::allocate(n * sizeof(T), alignof(T)));
+	}
+	void deallocate(T *, size_t) {
+		//(memory is reclaimed all at once by FrameArena::reset)
+	}
+
+	template< typename U >
+	bool operator==(FrameAllocator< U > const &) const { return true; }
+	template< typename U >
+	bool operator!=(FrameAllocator< U > const &) const { return false; }
+};
+
+template< typename T >
+using frame_vector = std::vector< T, FrameAllocator< T > >;
+
+using frame_string = std::basic_string< char, std::char_traits< char >, FrameAllocator< char > >;
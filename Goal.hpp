@@ -2,6 +2,7 @@
 
 struct Goal {
 	bool isGoal;
-	Scene::Transform *transform;
+	uint32_t entity = -1U; //index in Scene::entities
+	Scene::Transform *transform = nullptr; //(that entity's transform)
 	bool isCollected = false;
 };
@@ -0,0 +1,106 @@
+#include "InputScript.hpp"
+
+#include <cassert>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+InputScript::InputScript(std::string const &filename) {
+	std::ifstream in(filename, std::ios::binary);
+	if (!in) throw std::runtime_error("Failed to open input script '" + filename + "'.");
+
+	std::string line;
+	uint32_t line_number = 0;
+	while (std::getline(in, line)) {
+		line_number += 1;
+		auto fail = [&](std::string const &why) {
+			throw std::runtime_error("Input script '" + filename + "' line " + std::to_string(line_number) + ": " + why);
+		};
+
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		if (line.find_first_not_of(" \t") == std::string::npos || line[line.find_first_not_of(" \t")] == '#') continue;
+
+		std::istringstream words(line);
+		if (line.compare(0, 5, "seed ") == 0) {
+			std::string word;
+			if (!(words >> word >> seed)) fail("expecting 'seed <n>'.");
+			has_seed = true;
+			continue;
+		}
+		uint32_t frame = 0;
+		std::string type;
+		if (!(words >> frame >> type)) fail("expecting '<frame> <event>'.");
+		if (!entries.empty() && frame < entries.back().frame) fail("frames must not decrease.");
+
+		SDL_Event event;
+		SDL_zero(event);
+		if (type == "keydown" || type == "keyup") {
+			std::string name;
+			std::getline(words >> std::ws, name);
+			SDL_Keycode key = SDL_GetKeyFromName(name.c_str());
+			if (key == SDLK_UNKNOWN) fail("unknown key '" + name + "'.");
+			event.type = (type == "keydown" ? SDL_KEYDOWN : SDL_KEYUP);
+			event.key.state = (type == "keydown" ? SDL_PRESSED : SDL_RELEASED);
+			event.key.keysym.sym = key;
+			event.key.keysym.scancode = SDL_GetScancodeFromKey(key);
+		} else if (type == "motion") {
+			event.type = SDL_MOUSEMOTION;
+			if (!(words >> event.motion.x >> event.motion.y >> event.motion.xrel >> event.motion.yrel)) fail("expecting 'motion <x> <y> <xrel> <yrel>'.");
+		} else if (type == "buttondown" || type == "buttonup") {
+			int button = 0;
+			event.type = (type == "buttondown" ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP);
+			event.button.state = (type == "buttondown" ? SDL_PRESSED : SDL_RELEASED);
+			if (!(words >> button >> event.button.x >> event.button.y)) fail("expecting '" + type + " <button> <x> <y>'.");
+			event.button.button = uint8_t(button);
+			event.button.clicks = 1;
+		} else if (type == "quit") {
+			event.type = SDL_QUIT;
+		} else {
+			fail("unknown event type '" + type + "'.");
+		}
+		entries.emplace_back(Entry{frame, event});
+	}
+}
+
+void InputScript::save(std::string const &filename) const {
+	std::ofstream out(filename, std::ios::binary);
+	if (!out) throw std::runtime_error("Failed to open input script '" + filename + "' for writing.");
+
+	if (has_seed) out << "seed " << seed << '\n';
+	for (auto const &entry : entries) {
+		SDL_Event const &e = entry.event;
+		out << entry.frame << ' ';
+		if (e.type == SDL_KEYDOWN || e.type == SDL_KEYUP) {
+			out << (e.type == SDL_KEYDOWN ? "keydown " : "keyup ") << SDL_GetKeyName(e.key.keysym.sym);
+		} else if (e.type == SDL_MOUSEMOTION) {
+			out << "motion " << e.motion.x << ' ' << e.motion.y << ' ' << e.motion.xrel << ' ' << e.motion.yrel;
+		} else if (e.type == SDL_MOUSEBUTTONDOWN || e.type == SDL_MOUSEBUTTONUP) {
+			out << (e.type == SDL_MOUSEBUTTONDOWN ? "buttondown " : "buttonup ") << int(e.button.button) << ' ' << e.button.x << ' ' << e.button.y;
+		} else if (e.type == SDL_QUIT) {
+			out << "quit";
+		}
+		out << '\n';
+	}
+	if (!out) throw std::runtime_error("Failed to write input script '" + filename + "'.");
+}
+
+bool InputScript::add(uint32_t frame, SDL_Event const &event) {
+	if (!stores(event)) return false;
+	assert(entries.empty() || entries.back().frame <= frame);
+	entries.emplace_back(Entry{frame, event});
+	return true;
+}
+
+bool InputScript::stores(SDL_Event const &event) {
+	if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) {
+		return !event.key.repeat; //(key repeat depends on OS settings; skip it)
+	}
+	return event.type == SDL_MOUSEMOTION || event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEBUTTONUP || event.type == SDL_QUIT;
+}
+
+bool InputScript::Player::next(uint32_t frame, SDL_Event *event) {
+	if (at >= script.entries.size() || script.entries[at].frame > frame) return false;
+	*event = script.entries[at].event;
+	at += 1;
+	return true;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+/*
+ * InputScript is a list of input events, each tagged with the frame it should be
+ * delivered on -- used to drive modes without a human (see benchmark.cpp) and to
+ * record and replay sessions (see --record and --replay in main.cpp).
+ *
+ * A "frame" here is a count of updates (Mode::updates): an event tagged with
+ * frame N is delivered after N updates have run. (When there is one update per
+ * frame, as in the benchmark and during replay, the two are the same.)
+ *
+ * Scripts are text files with one event per line:
+ *
+ *   # comment
+ *   seed <n>                            (optional; random seed for the mode)
+ *   <frame> keydown <key name>          (key names as in SDL_GetKeyName, e.g. "W", "Left Shift")
+ *   <frame> keyup <key name>
+ *   <frame> motion <x> <y> <xrel> <yrel>
+ *   <frame> buttondown <button> <x> <y>
+ *   <frame> buttonup <button> <x> <y>
+ *   <frame> quit
+ *
+ * Frames are counted from zero and must not decrease from line to line.
+ *
+ */
+
+#include <SDL.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct InputScript {
+	struct Entry {
+		uint32_t frame;
+		SDL_Event event;
+	};
+	std::vector< Entry > entries; //in frame order
+
+	bool has_seed = false;
+	uint32_t seed = 0;
+
+	//empty script:
+	InputScript() = default;
+
+	//load from a file (throws on errors):
+	InputScript(std::string const &filename);
+
+	//write to a file (throws on errors):
+	void save(std::string const &filename) const;
+
+	//append an event (returns false, and ignores the event, if it isn't one scripts store):
+	bool add(uint32_t frame, SDL_Event const &event);
+
+	//is 'event' a kind that scripts store? (keyboard, mouse, and quit events; not key repeats)
+	static bool stores(SDL_Event const &event);
+
+	//Walks through a script, frame by frame:
+	struct Player {
+		Player(InputScript const &script_) : script(script_) { }
+		//get the next event for 'frame' (returns false once there are none left for this frame):
+		bool next(uint32_t frame, SDL_Event *event);
+		//have all events been delivered?
+		bool done() const { return at >= script.entries.size(); }
+
+		InputScript const &script;
+		size_t at = 0; //next entry to deliver
+	};
+};
@@ -0,0 +1,235 @@
+#include "Jobs.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <thread>
+
+namespace {
+	struct Job {
+		std::function< void() > fn;
+		Jobs::Counter *counter;
+	};
+
+	//each thread's jobs; the owner takes from the back, thieves from the front:
+	struct Lane {
+		std::mutex mutex;
+		std::deque< Job > jobs;
+	};
+
+	struct State {
+		std::thread::id main_thread = std::this_thread::get_id();
+
+		//lanes[0] is the main thread's; lanes[1+i] is workers[i]'s:
+		std::vector< std::unique_ptr< Lane > > lanes;
+		std::vector< std::thread > workers;
+
+		//jobs only the main thread may run:
+		std::mutex main_mutex;
+		std::deque< Job > main_jobs;
+
+		//idle workers sleep until something is queued:
+		std::atomic< uint32_t > queued{0};
+		std::mutex sleep_mutex;
+		std::condition_variable sleep_cv;
+		bool quit = false;
+
+		std::atomic< uint32_t > next_lane{0}; //(for jobs queued by threads without a lane)
+
+		State() {
+			lanes.emplace_back(new Lane);
+		}
+	};
+
+	State &state() {
+		static State state;
+		return state;
+	}
+
+	thread_local uint32_t lane_index = -1U; //lane owned by this thread (if any)
+
+	void finish(Jobs::Counter *counter);
+
+	void push(Job const &job) {
+		State &s = state();
+		uint32_t index = lane_index;
+		if (index == -1U) index = s.next_lane.fetch_add(1, std::memory_order_relaxed) % uint32_t(s.lanes.size());
+		{
+			Lane &lane = *s.lanes[index];
+			std::unique_lock< std::mutex > lock(lane.mutex);
+			lane.jobs.emplace_back(job);
+		}
+		s.queued.fetch_add(1, std::memory_order_release);
+		if (!s.workers.empty()) {
+			std::unique_lock< std::mutex > lock(s.sleep_mutex); //(so a worker about to sleep can't miss the notification)
+			s.sleep_cv.notify_one();
+		}
+	}
+
+	//take a job from this thread's own lane, or else steal one:
+	bool pop(Job *job) {
+		State &s = state();
+		if (s.queued.load(std::memory_order_acquire) == 0) return false;
+		uint32_t count = uint32_t(s.lanes.size());
+		uint32_t own = (lane_index == -1U ? 0 : lane_index);
+		for (uint32_t o = 0; o < count; ++o) {
+			uint32_t index = (own + o) % count;
+			Lane &lane = *s.lanes[index];
+			std::unique_lock< std::mutex > lock(lane.mutex);
+			if (lane.jobs.empty()) continue;
+			if (index == lane_index) {
+				*job = std::move(lane.jobs.back());
+				lane.jobs.pop_back();
+			} else {
+				*job = std::move(lane.jobs.front());
+				lane.jobs.pop_front();
+			}
+			s.queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+		return false;
+	}
+
+	bool pop_main(Job *job) {
+		State &s = state();
+		std::unique_lock< std::mutex > lock(s.main_mutex);
+		if (s.main_jobs.empty()) return false;
+		*job = std::move(s.main_jobs.front());
+		s.main_jobs.pop_front();
+		return true;
+	}
+
+	void execute(Job &job) {
+		job.fn();
+		if (job.counter) finish(job.counter);
+	}
+
+	void finish(Jobs::Counter *counter) {
+		//(the counter is only touched while locked, so Jobs::wait can tell when it is safe to return -- and the counter to be destroyed)
+		std::vector< std::function< void() > > waiting;
+		{
+			std::unique_lock< std::mutex > lock(counter->mutex);
+			if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				waiting.swap(counter->waiting);
+			}
+		}
+		//counter is done, so start anything that was waiting on it:
+		for (auto &fn : waiting) fn();
+	}
+
+	void worker_main(uint32_t index) {
+		State &s = state();
+		lane_index = index;
+		Job job;
+		while (true) {
+			if (pop(&job)) {
+				execute(job);
+				continue;
+			}
+			std::unique_lock< std::mutex > lock(s.sleep_mutex);
+			s.sleep_cv.wait(lock, [&s](){ return s.quit || s.queued.load(std::memory_order_acquire) != 0; });
+			if (s.quit && s.queued.load(std::memory_order_acquire) == 0) break;
+		}
+	}
+}
+
+void Jobs::init(uint32_t workers) {
+	State &s = state();
+	assert(s.workers.empty() && "Jobs::init should only be called once.");
+	s.main_thread = std::this_thread::get_id();
+	lane_index = 0;
+
+	if (workers == -1U) {
+		uint32_t cores = std::thread::hardware_concurrency();
+		workers = (cores > 1 ? cores - 1 : 0);
+	}
+	for (uint32_t i = 0; i < workers; ++i) {
+		s.lanes.emplace_back(new Lane);
+	}
+	for (uint32_t i = 0; i < workers; ++i) {
+		s.workers.emplace_back(worker_main, i + 1);
+	}
+}
+
+void Jobs::shutdown() {
+	State &s = state();
+	assert(is_main_thread());
+	run_main_jobs();
+	{
+		std::unique_lock< std::mutex > lock(s.sleep_mutex);
+		s.quit = true;
+	}
+	s.sleep_cv.notify_all();
+	for (auto &worker : s.workers) {
+		worker.join();
+	}
+	s.workers.clear();
+
+	//(without workers, anything left is up to this thread)
+	Job job;
+	while (pop(&job)) execute(job);
+	run_main_jobs();
+}
+
+void Jobs::run(std::function< void() > const &fn, Counter *counter, Counter *after) {
+	if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+	Job job{fn, counter};
+	if (after) {
+		std::unique_lock< std::mutex > lock(after->mutex);
+		if (!after->done()) {
+			after->waiting.emplace_back([job](){ push(job); });
+			return;
+		}
+	}
+	push(job);
+}
+
+void Jobs::run_on_main(std::function< void() > const &fn, Counter *counter) {
+	if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+	State &s = state();
+	std::unique_lock< std::mutex > lock(s.main_mutex);
+	s.main_jobs.emplace_back(Job{fn, counter});
+}
+
+void Jobs::wait(Counter &counter) {
+	Job job;
+	while (!counter.done()) {
+		if (pop(&job)) execute(job);
+		else std::this_thread::yield(); //(remaining jobs are running elsewhere)
+	}
+	//make sure the last finish() is done with the counter:
+	std::unique_lock< std::mutex > lock(counter.mutex);
+}
+
+void Jobs::parallel_for(uint32_t begin, uint32_t end, uint32_t grain, std::function< void(uint32_t, uint32_t) > const &fn) {
+	assert(grain > 0);
+	if (begin >= end) return;
+	//small ranges (or no one to share with) aren't worth queueing:
+	if (end - begin <= grain || state().workers.empty()) {
+		for (uint32_t first = begin; first < end; first += std::min(grain, end - first)) {
+			fn(first, first + std::min(grain, end - first));
+		}
+		return;
+	}
+
+	Counter counter;
+	uint32_t first = begin;
+	while (end - first > grain) {
+		run([&fn, first, grain](){ fn(first, first + grain); }, &counter);
+		first += grain;
+	}
+	fn(first, end); //(last chunk runs here)
+	wait(counter);
+}
+
+void Jobs::run_main_jobs() {
+	assert(is_main_thread());
+	Job job;
+	while (pop_main(&job)) execute(job);
+}
+
+bool Jobs::is_main_thread() {
+	return std::this_thread::get_id() == state().main_thread;
+}
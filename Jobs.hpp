@@ -0,0 +1,81 @@
+#pragma once
+
+/*
+ * Jobs is a small work-stealing job system for spreading per-frame work
+ * (transform updates, culling, particle simulation, ...) over every core:
+ *
+ *  - Jobs::run(fn) queues a job. Each thread has its own deque of jobs: it runs
+ *    its own newest jobs first, and when it runs out it steals the oldest jobs
+ *    from other threads.
+ *  - A Counter counts unfinished jobs. Jobs::wait(counter) runs other jobs until
+ *    the counter reaches zero, and Jobs::run(fn, counter, &after) holds a job
+ *    back until the 'after' counter is done (i.e., expresses a dependency).
+ *  - Jobs::parallel_for(begin, end, grain, fn) splits a range into chunks of
+ *    'grain' items and returns once they have all been processed.
+ *  - Jobs::run_on_main(fn) queues a job that only the main (OpenGL context)
+ *    thread will run -- use it for GL calls (e.g., the upload half of a
+ *    hot-reloaded asset; see AssetCache.hpp). The main thread only runs these
+ *    in run_main_jobs(), which main.cpp calls between frames -- never in the
+ *    middle of other code's GL state.
+ *
+ * init() starts one worker per core (less one for the main thread). Before
+ * init() (e.g., in the asset viewers) or on single-core machines, all jobs run
+ * on whichever thread waits for them.
+ *
+ * Jobs should be short and shouldn't block on I/O (that's what the load workers
+ * in Load.cpp are for).
+ *
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace Jobs {
+
+//Start worker threads (call once, from the main thread):
+// (-1U means one per core, less one for the main thread)
+void init(uint32_t workers = -1U);
+
+//Finish any queued jobs and stop worker threads:
+void shutdown();
+
+//Counts unfinished jobs:
+struct Counter {
+	Counter() = default;
+	Counter(Counter const &) = delete;
+	Counter &operator=(Counter const &) = delete;
+
+	bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+
+	std::atomic< uint32_t > pending{0};
+
+	//jobs waiting (see 'after' in run()) for 'pending' to reach zero:
+	std::mutex mutex;
+	std::vector< std::function< void() > > waiting;
+};
+
+//Queue 'job' to run on any thread:
+// if 'counter' is given, it counts the job until it has finished;
+// if 'after' is given, the job isn't started until 'after' is done.
+void run(std::function< void() > const &job, Counter *counter = nullptr, Counter *after = nullptr);
+
+//Queue 'job' to run on the main thread (e.g., because it makes OpenGL calls):
+void run_on_main(std::function< void() > const &job, Counter *counter = nullptr);
+
+//Run jobs until 'counter' is done:
+// (main-thread jobs aren't run here, so don't wait from the main thread on a counter that counts them)
+void wait(Counter &counter);
+
+//Call fn(first, last) on chunks of at most 'grain' items that together cover [begin, end):
+// (returns once all chunks are done; the calling thread processes chunks too)
+void parallel_for(uint32_t begin, uint32_t end, uint32_t grain, std::function< void(uint32_t, uint32_t) > const &fn);
+
+//Run queued main-thread jobs (main.cpp calls this once per frame):
+void run_main_jobs();
+
+bool is_main_thread();
+
+} //namespace Jobs
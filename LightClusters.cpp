@@ -0,0 +1,276 @@
+#include "LightClusters.hpp"
+
+#include "LitColorTextureProgram.hpp"
+#include "ShadowMaps.hpp"
+#include "Jobs.hpp"
+#include "gl_errors.hpp"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+
+//lights tested at once by the sphere vs. box loop:
+static constexpr uint32_t Lanes = 8;
+
+static_assert(LightClusters::MaxLightsPerCluster <= 0xffff, "Cluster counts are 16-bit.");
+
+LightClusters::LightClusters() {
+	cluster_counts.resize(Clusters);
+	cluster_lights.resize(Clusters * MaxLightsPerCluster);
+	cluster_texels.resize(Clusters);
+	slice_lights.resize(Slices);
+
+	auto make = [](GLuint *buffer, GLuint *texture, GLenum format) {
+		glGenBuffers(1, buffer);
+		glBindBuffer(GL_TEXTURE_BUFFER, *buffer);
+		glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW); //(resized by update())
+		glGenTextures(1, texture);
+		glBindTexture(GL_TEXTURE_BUFFER, *texture);
+		glTexBuffer(GL_TEXTURE_BUFFER, format, *buffer);
+	};
+	make(&light_buffer, &light_texture, GL_RGBA32F);
+	make(&cluster_buffer, &cluster_texture, GL_RG32UI);
+	make(&index_buffer, &index_texture, GL_R16UI);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	GL_ERRORS();
+}
+
+LightClusters::~LightClusters() {
+	GLuint textures[3] = { light_texture, cluster_texture, index_texture };
+	glDeleteTextures(3, textures);
+	GLuint buffers[3] = { light_buffer, cluster_buffer, index_buffer };
+	glDeleteBuffers(3, buffers);
+	light_texture = cluster_texture = index_texture = 0;
+	light_buffer = cluster_buffer = index_buffer = 0;
+}
+
+void LightClusters::update(Scene::List< Scene::Light > const &lights, Scene::Camera const &camera, glm::uvec2 const &drawable_size, ShadowMaps const *shadows) {
+	assert(camera.transform);
+
+	float near = camera.near;
+	float far_ = std::max(far, 2.0f * near);
+	float log_ratio = std::log(far_ / near);
+	depth_to_slice = glm::vec2(float(Slices) / log_ratio, -std::log(near) * float(Slices) / log_ratio);
+	tile_size = glm::max(glm::vec2(drawable_size), glm::vec2(1.0f)) / glm::vec2(TilesX, TilesY);
+
+	//slice containing view depth 'depth' (clamped to the grid):
+	auto slice_of = [&](float depth) -> uint32_t {
+		if (depth <= near) return 0;
+		float s = std::floor(std::log(depth) * depth_to_slice.x + depth_to_slice.y);
+		return uint32_t(std::min(std::max(s, 0.0f), float(Slices - 1)));
+	};
+
+	//----- gather lights -----
+	glm::mat4x3 world_to_view = camera.transform->make_world_to_local();
+
+	globals.clear();
+	light_texels.clear();
+	view_x.clear(); view_y.clear(); view_z.clear(); radius.clear();
+	bool too_many = false;
+	for (auto const &light : lights) {
+		glm::mat4x3 light_to_world = light.transform->make_local_to_world();
+		glm::vec3 direction = -glm::normalize(light_to_world[2]); //(lights point along -z)
+
+		if (light.type == Scene::Light::Hemisphere || light.type == Scene::Light::Directional) {
+			if (globals.size() == MaxGlobalLights) {
+				too_many = true;
+				continue;
+			}
+			bool shadowed = (shadows && shadows->cascade_light == &light);
+			globals.emplace_back(GlobalLight{ (light.type == Scene::Light::Hemisphere ? 1 : 3), direction, light.energy, shadowed });
+			continue;
+		}
+
+		float brightest = std::max(light.energy.r, std::max(light.energy.g, light.energy.b));
+		if (!(brightest > 0.0f)) continue;
+		float range = std::sqrt(brightest / cutoff);
+
+		glm::vec3 at = world_to_view * glm::vec4(light_to_world[3], 1.0f);
+		//skip lights that don't reach the grid:
+		if (-at.z + range < near || -at.z - range > far_) continue;
+
+		if (view_x.size() == MaxLights) {
+			too_many = true;
+			continue;
+		}
+
+		view_x.emplace_back(at.x);
+		view_y.emplace_back(at.y);
+		view_z.emplace_back(at.z);
+		radius.emplace_back(range);
+
+		bool spot = (light.type == Scene::Light::Spot);
+		light_texels.emplace_back(light_to_world[3], range);
+		light_texels.emplace_back(direction, spot ? std::cos(0.5f * light.spot_fov) : -1.0f); //(cutoff -1 means a point light)
+		int32_t shadow = (spot && shadows ? shadows->spot_slot(&light) : -1);
+		light_texels.emplace_back(light.energy, float(shadow));
+	}
+	if (too_many) {
+		static bool warned = false;
+		if (!warned) {
+			std::cerr << "WARNING: scene has more lights than LightClusters can handle; ignoring some." << std::endl;
+			warned = true;
+		}
+	}
+	binned = uint32_t(view_x.size());
+
+	//----- find the lights that reach each slice -----
+	for (auto &list : slice_lights) list.clear();
+	for (uint32_t i = 0; i < binned; ++i) {
+		uint32_t first = slice_of(-view_z[i] - radius[i]);
+		uint32_t last = slice_of(-view_z[i] + radius[i]);
+		for (uint32_t s = first; s <= last; ++s) {
+			slice_lights[s].emplace_back(uint16_t(i));
+		}
+	}
+
+	//----- test each slice's lights against its tiles -----
+	float tan_y = std::tan(0.5f * camera.fovy);
+	float tan_x = tan_y * camera.aspect;
+	float log_near = std::log(near);
+
+	std::fill(cluster_counts.begin(), cluster_counts.end(), uint16_t(0));
+	std::atomic< uint32_t > total_dropped(0);
+	Jobs::parallel_for(0, Slices, 1, [&](uint32_t first_slice, uint32_t last_slice) {
+		//(per-thread scratch, reused between frames so this doesn't allocate once warmed up)
+		thread_local std::vector< float > x, y, z, r2;
+		thread_local std::vector< uint8_t > hit;
+
+		for (uint32_t s = first_slice; s < last_slice; ++s) {
+			std::vector< uint16_t > const &list = slice_lights[s];
+			uint32_t count = uint32_t(list.size());
+			if (count == 0) continue;
+
+			//gather this slice's lights, so the test loop below reads them contiguously:
+			// (padded to whole blocks of Lanes with lights that never hit)
+			uint32_t padded = (count + Lanes - 1) / Lanes * Lanes;
+			x.assign(padded, 0.0f); y.assign(padded, 0.0f); z.assign(padded, 0.0f); r2.assign(padded, -1.0f); hit.resize(padded);
+			for (uint32_t j = 0; j < count; ++j) {
+				x[j] = view_x[list[j]];
+				y[j] = view_y[list[j]];
+				z[j] = view_z[list[j]];
+				r2[j] = radius[list[j]] * radius[list[j]];
+			}
+
+			//depth range of the slice (view space looks down -z):
+			float d0 = std::exp(log_near + float(s) / depth_to_slice.x);
+			float d1 = std::exp(log_near + float(s + 1) / depth_to_slice.x);
+			float const min_z = -d1;
+			float const max_z = -d0;
+
+			for (uint32_t ty = 0; ty < TilesY; ++ty) {
+				//(a tile's edges are planes through the eye, so its box spans both ends of the depth range)
+				float y0 = (-1.0f + 2.0f * float(ty) / float(TilesY)) * tan_y;
+				float y1 = (-1.0f + 2.0f * float(ty + 1) / float(TilesY)) * tan_y;
+				float const min_y = std::min(y0 * d0, y0 * d1);
+				float const max_y = std::max(y1 * d0, y1 * d1);
+				for (uint32_t tx = 0; tx < TilesX; ++tx) {
+					float x0 = (-1.0f + 2.0f * float(tx) / float(TilesX)) * tan_x;
+					float x1 = (-1.0f + 2.0f * float(tx + 1) / float(TilesX)) * tan_x;
+					float const min_x = std::min(x0 * d0, x0 * d1);
+					float const max_x = std::max(x1 * d0, x1 * d1);
+
+					//sphere vs. box, as distance outside the box's (center, half-size) on each axis:
+					// (a block of Lanes at a time with one select per loop, so each loop vectorizes -- as in Particle.cpp)
+					float const center_x = 0.5f * (min_x + max_x), half_x = 0.5f * (max_x - min_x);
+					float const center_y = 0.5f * (min_y + max_y), half_y = 0.5f * (max_y - min_y);
+					float const center_z = 0.5f * (min_z + max_z), half_z = 0.5f * (max_z - min_z);
+					for (uint32_t b = 0; b < padded; b += Lanes) {
+						float dx[Lanes], dy[Lanes], dz[Lanes];
+						for (uint32_t l = 0; l < Lanes; ++l) dx[l] = std::max(std::fabs(x[b + l] - center_x) - half_x, 0.0f);
+						for (uint32_t l = 0; l < Lanes; ++l) dy[l] = std::max(std::fabs(y[b + l] - center_y) - half_y, 0.0f);
+						for (uint32_t l = 0; l < Lanes; ++l) dz[l] = std::max(std::fabs(z[b + l] - center_z) - half_z, 0.0f);
+						float d2[Lanes];
+						for (uint32_t l = 0; l < Lanes; ++l) d2[l] = dx[l] * dx[l] + dy[l] * dy[l] + dz[l] * dz[l] - r2[b + l];
+						for (uint32_t l = 0; l < Lanes; ++l) hit[b + l] = uint8_t(d2[l] <= 0.0f ? 1 : 0);
+					}
+
+					uint32_t cluster = (s * TilesY + ty) * TilesX + tx;
+					uint16_t *out = &cluster_lights[cluster * MaxLightsPerCluster];
+					uint32_t n = 0;
+					uint32_t over = 0;
+					for (uint32_t j = 0; j < count; ++j) {
+						if (!hit[j]) continue;
+						if (n < MaxLightsPerCluster) out[n++] = list[j];
+						else over += 1;
+					}
+					cluster_counts[cluster] = uint16_t(n);
+					if (over) total_dropped += over;
+				}
+			}
+		}
+	});
+	dropped = total_dropped;
+
+	//----- pack clusters' lists end to end -----
+	index_texels.clear();
+	for (uint32_t c = 0; c < Clusters; ++c) {
+		cluster_texels[c] = glm::uvec2(uint32_t(index_texels.size()), cluster_counts[c]);
+		uint16_t const *list = &cluster_lights[c * MaxLightsPerCluster];
+		index_texels.insert(index_texels.end(), list, list + cluster_counts[c]);
+	}
+	entries = uint32_t(index_texels.size());
+
+	//----- upload -----
+	auto upload = [](GLuint buffer, void const *data, size_t size) {
+		glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+		//(re-specifying the whole store lets the driver hand back fresh memory rather than wait for last frame's draws)
+		glBufferData(GL_TEXTURE_BUFFER, std::max< size_t >(size, 16), nullptr, GL_STREAM_DRAW);
+		if (size) glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+	};
+	upload(light_buffer, light_texels.data(), light_texels.size() * sizeof(glm::vec4));
+	upload(cluster_buffer, cluster_texels.data(), cluster_texels.size() * sizeof(glm::uvec2));
+	upload(index_buffer, index_texels.data(), index_texels.size() * sizeof(uint16_t));
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	GL_ERRORS();
+}
+
+void LightClusters::bind() const {
+	LitColorTextureProgram const &program = *lit_color_texture_program;
+
+	glUseProgram(program.program);
+	glUniform3i(program.CLUSTER_COUNT_ivec3, TilesX, TilesY, Slices);
+	glUniform2fv(program.CLUSTER_TILE_vec2, 1, glm::value_ptr(tile_size));
+	glUniform2fv(program.CLUSTER_DEPTH_vec2, 1, glm::value_ptr(depth_to_slice));
+
+	int types[MaxGlobalLights] = { };
+	int shadowed[MaxGlobalLights] = { };
+	glm::vec3 directions[MaxGlobalLights];
+	glm::vec3 energies[MaxGlobalLights];
+	for (uint32_t i = 0; i < globals.size(); ++i) {
+		types[i] = globals[i].type;
+		directions[i] = globals[i].direction;
+		energies[i] = globals[i].energy;
+		shadowed[i] = (globals[i].shadowed ? 1 : 0);
+	}
+	glUniform1i(program.GLOBAL_LIGHTS_int, GLint(globals.size()));
+	glUniform1iv(program.GLOBAL_LIGHT_TYPE_int_array, MaxGlobalLights, types);
+	glUniform3fv(program.GLOBAL_LIGHT_DIRECTION_vec3_array, MaxGlobalLights, glm::value_ptr(directions[0]));
+	glUniform3fv(program.GLOBAL_LIGHT_ENERGY_vec3_array, MaxGlobalLights, glm::value_ptr(energies[0]));
+	glUniform1iv(program.GLOBAL_LIGHT_SHADOW_int_array, MaxGlobalLights, shadowed);
+	glUseProgram(0);
+
+	glActiveTexture(GL_TEXTURE0 + LitColorTextureProgram::LightsTextureUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, light_texture);
+	glActiveTexture(GL_TEXTURE0 + LitColorTextureProgram::ClustersTextureUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, cluster_texture);
+	glActiveTexture(GL_TEXTURE0 + LitColorTextureProgram::ClusterLightsTextureUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, index_texture);
+	glActiveTexture(GL_TEXTURE0);
+
+	GL_ERRORS();
+}
+
+void LightClusters::unbind() const {
+	for (GLuint unit : { LitColorTextureProgram::LightsTextureUnit, LitColorTextureProgram::ClustersTextureUnit, LitColorTextureProgram::ClusterLightsTextureUnit }) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+	}
+	glActiveTexture(GL_TEXTURE0);
+}
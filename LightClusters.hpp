@@ -0,0 +1,105 @@
+#pragma once
+
+/*
+ * LightClusters lights lit_color_texture_program with a scene's lights, using
+ * clustered forward shading:
+ *
+ *  - The view frustum is split into a grid of clusters: TilesX x TilesY tiles on
+ *    screen, times Slices depth slices (spaced exponentially from the camera's
+ *    near plane out to 'far').
+ *  - update() bins each point and spot light into the clusters its range
+ *    touches: a pre-pass finds the lights that reach each slice, then each
+ *    slice's tiles are tested against those lights (sphere vs. box, with lights
+ *    stored structure-of-arrays so the test loop compiles to SIMD code), with
+ *    slices split over the job system.
+ *  - The lights, each cluster's (first, count), and the per-cluster light
+ *    indices are uploaded as buffer textures, so the fragment shader only loops
+ *    over the lights in its own cluster.
+ *
+ * Hemisphere and directional lights reach everything, so they aren't binned;
+ * up to MaxGlobalLights of them are passed as plain uniforms.
+ *
+ * Point and spot lights fall off as 1/distance^2, so each is given a range
+ * (where its brightest channel drops to 'cutoff'), and the shader fades it
+ * smoothly to zero there -- binning never visibly cuts a light off.
+ *
+ * Given ShadowMaps, lights that have shadow maps are marked so the shader
+ * looks them up.
+ *
+ * Light positions are uploaded in world space, which lit_color_texture_program
+ * calls "light space" (i.e., draw with Scene::draw's default world_to_light).
+ *
+ * Only use from the main (OpenGL context) thread.
+ *
+ */
+
+#include "GL.hpp"
+#include "Scene.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+struct ShadowMaps;
+
+struct LightClusters {
+	LightClusters();
+	~LightClusters();
+	LightClusters(LightClusters const &) = delete;
+	LightClusters &operator=(LightClusters const &) = delete;
+
+	//bin 'lights' for drawing from 'camera' into a framebuffer of size 'drawable_size':
+	// (if 'shadows' is given, its update() should already have been called for this frame)
+	void update(Scene::List< Scene::Light > const &lights, Scene::Camera const &camera, glm::uvec2 const &drawable_size, ShadowMaps const *shadows = nullptr);
+
+	//bind the buffer textures and set lit_color_texture_program's lighting uniforms (call before drawing):
+	void bind() const;
+	//unbind the buffer textures (call after drawing):
+	void unbind() const;
+
+	static constexpr uint32_t TilesX = 16;
+	static constexpr uint32_t TilesY = 9;
+	static constexpr uint32_t Slices = 24;
+	static constexpr uint32_t Clusters = TilesX * TilesY * Slices;
+	static constexpr uint32_t MaxLightsPerCluster = 128; //(past this, lights are dropped from a cluster)
+	static constexpr uint32_t MaxLights = 0xffff; //point and spot lights in the grid (light indices are 16-bit)
+	static constexpr uint32_t MaxGlobalLights = 4; //hemisphere and directional lights (must match the shader)
+
+	float far = 100.0f; //lights beyond this distance from the camera are ignored
+	float cutoff = 1.0f / 256.0f; //point and spot lights reach until their energy drops below this
+
+	//hemisphere and directional lights (from the last update()):
+	struct GlobalLight {
+		int type; //shader's light type: 1 = hemisphere, 3 = directional
+		glm::vec3 direction; //(world space)
+		glm::vec3 energy;
+		bool shadowed; //(uses shadows' cascades)
+	};
+	std::vector< GlobalLight > globals;
+
+	//statistics from the last update():
+	uint32_t binned = 0; //point and spot lights in the grid
+	uint32_t entries = 0; //(cluster, light) pairs
+	uint32_t dropped = 0; //(cluster, light) pairs that didn't fit in MaxLightsPerCluster
+
+	//---- internals ----
+	glm::vec2 tile_size = glm::vec2(1.0f); //pixels per tile
+	glm::vec2 depth_to_slice = glm::vec2(0.0f); //slice = log(depth) * x + y
+
+	//point and spot lights, three texels each: (position, range), (direction, spot cutoff or -1), (energy, shadow map slot or -1):
+	std::vector< glm::vec4 > light_texels;
+	//the same lights' bounding spheres, in view space, structure-of-arrays style:
+	std::vector< float > view_x, view_y, view_z, radius;
+
+	std::vector< std::vector< uint16_t > > slice_lights; //lights that reach each slice
+	std::vector< uint16_t > cluster_counts; //lights in each cluster...
+	std::vector< uint16_t > cluster_lights; //...and which (MaxLightsPerCluster slots per cluster)
+	std::vector< glm::uvec2 > cluster_texels; //(first, count) for each cluster...
+	std::vector< uint16_t > index_texels; //...in these (all clusters' lights, concatenated)
+
+	//buffers and the buffer textures that read them:
+	GLuint light_buffer = 0, light_texture = 0; //GL_RGBA32F, from light_texels
+	GLuint cluster_buffer = 0, cluster_texture = 0; //GL_RG32UI, from cluster_texels
+	GLuint index_buffer = 0, index_texture = 0; //GL_R16UI, from index_texels
+};
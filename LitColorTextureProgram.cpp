@@ -16,13 +16,7 @@ Load< LitColorTextureProgram > lit_color_texture_program(LoadTagEarly, []() -> L
 	lit_color_texture_program_pipeline.NORMAL_TO_LIGHT_mat3 = ret->NORMAL_TO_LIGHT_mat3;
 	lit_color_texture_program_pipeline.OBJECT_TO_VIEW_mat4x3 = ret->OBJECT_TO_VIEW_mat4x3;
 
-	/* This will be used later if/when we build a light loop into the Scene:
-	lit_color_texture_program_pipeline.LIGHT_TYPE_int = ret->LIGHT_TYPE_int;
-	lit_color_texture_program_pipeline.LIGHT_LOCATION_vec3 = ret->LIGHT_LOCATION_vec3;
-	lit_color_texture_program_pipeline.LIGHT_DIRECTION_vec3 = ret->LIGHT_DIRECTION_vec3;
-	lit_color_texture_program_pipeline.LIGHT_ENERGY_vec3 = ret->LIGHT_ENERGY_vec3;
-	lit_color_texture_program_pipeline.LIGHT_CUTOFF_float = ret->LIGHT_CUTOFF_float;
-	*/
+	//(lights aren't per-drawable: LightClusters sets them up for the whole scene)
 
 
 	//make a 1-pixel white texture to bind by default:
@@ -75,11 +69,27 @@ LitColorTextureProgram::LitColorTextureProgram() {
 		//fragment shader:
 		"#version 330\n"
 		"uniform sampler2D TEX;\n"
-		"uniform int LIGHT_TYPE;\n"
-		"uniform vec3 LIGHT_LOCATION;\n"
-		"uniform vec3 LIGHT_DIRECTION;\n"
-		"uniform vec3 LIGHT_ENERGY;\n"
-		"uniform float LIGHT_CUTOFF;\n"
+		//point and spot lights, binned into clusters (see LightClusters):
+		"uniform samplerBuffer LIGHTS;\n" //three texels per light: (position, range), (direction, spot cutoff), (energy, shadow)
+		"uniform usamplerBuffer CLUSTERS;\n" //(first, count) in CLUSTER_LIGHTS for each cluster
+		"uniform usamplerBuffer CLUSTER_LIGHTS;\n" //indices into LIGHTS
+		"uniform ivec3 CLUSTER_COUNT;\n" //tiles across, tiles up, slices
+		"uniform vec2 CLUSTER_TILE;\n" //tile size in pixels
+		"uniform vec2 CLUSTER_DEPTH;\n" //slice = log(depth) * x + y
+		//hemisphere and directional lights, which light everything:
+		"uniform int GLOBAL_LIGHTS;\n"
+		"uniform int GLOBAL_LIGHT_TYPE[4];\n"
+		"uniform vec3 GLOBAL_LIGHT_DIRECTION[4];\n"
+		"uniform vec3 GLOBAL_LIGHT_ENERGY[4];\n"
+		"uniform int GLOBAL_LIGHT_SHADOW[4];\n" //1 if the light uses the cascades
+		//shadow maps (see ShadowMaps):
+		"uniform sampler2DArrayShadow CASCADE_SHADOW;\n" //one layer per cascade
+		"uniform mat4 CASCADE_WORLD_TO_SHADOW[4];\n"
+		"uniform vec4 CASCADE_SPLITS;\n" //view depth where each cascade ends
+		"uniform vec4 CASCADE_TEXEL;\n" //size of each cascade's texels
+		"uniform sampler2DShadow SPOT_SHADOW;\n" //atlas of spot light maps
+		"uniform mat4 SPOT_WORLD_TO_SHADOW[16];\n"
+		"uniform float SPOT_SHADOW_TEXEL[16];\n" //size of each map's texels at unit distance
 		"uniform vec3 CAMERA_LOCATION;\n"
 		"uniform vec4 FOG_COLOR;\n"
 		"in vec3 position;\n"
@@ -88,27 +98,52 @@ LitColorTextureProgram::LitColorTextureProgram() {
 		"in vec4 color;\n"
 		"in vec2 texCoord;\n"
 		"out vec4 fragColor;\n"
+		//(lookups are nudged along the normal by a texel or so, so surfaces don't shadow themselves)
+		"float cascade_shadow(vec3 n) {\n"
+		"	int c = int(dot(vec4(greaterThanEqual(vec4(-viewPosition.z), CASCADE_SPLITS)), vec4(1.0)));\n"
+		"	if (c >= 4) return 1.0;\n"
+		"	vec4 s = CASCADE_WORLD_TO_SHADOW[c] * vec4(position + n * (1.5 * CASCADE_TEXEL[c]), 1.0);\n"
+		"	return texture(CASCADE_SHADOW, vec4(s.xy, float(c), s.z));\n"
+		"}\n"
+		"float spot_shadow(int slot, vec3 n, float dist) {\n"
+		"	vec4 s = SPOT_WORLD_TO_SHADOW[slot] * vec4(position + n * (1.5 * SPOT_SHADOW_TEXEL[slot] * dist), 1.0);\n"
+		"	return texture(SPOT_SHADOW, s.xyz / s.w);\n"
+		"}\n"
 		"void main() {\n"
 		"	vec3 n = normalize(normal);\n"
-		"	vec3 e;\n"
-		"	if (LIGHT_TYPE == 0) { //point light \n"
-		"		vec3 l = (LIGHT_LOCATION - position);\n"
-		"		float dis2 = dot(l,l);\n"
-		"		l = normalize(l);\n"
-		"		float nl = max(0.0, dot(n, l)) / max(1.0, dis2);\n"
-		"		e = nl * LIGHT_ENERGY;\n"
-		"	} else if (LIGHT_TYPE == 1) { //hemi light \n"
-		"		e = (dot(n,-LIGHT_DIRECTION) * 0.5 + 0.5) * LIGHT_ENERGY;\n"
-		"	} else if (LIGHT_TYPE == 2) { //spot light \n"
-		"		vec3 l = (LIGHT_LOCATION - position);\n"
-		"		float dis2 = dot(l,l);\n"
-		"		l = normalize(l);\n"
-		"		float nl = max(0.0, dot(n, l)) / max(1.0, dis2);\n"
-		"		float c = dot(l,-LIGHT_DIRECTION);\n"
-		"		nl *= smoothstep(LIGHT_CUTOFF,mix(LIGHT_CUTOFF,1.0,0.1), c);\n"
-		"		e = nl * LIGHT_ENERGY;\n"
-		"	} else { //(LIGHT_TYPE == 3) //directional light \n"
-		"		e = max(0.0, dot(n,-LIGHT_DIRECTION)) * LIGHT_ENERGY;\n"
+		"	vec3 e = vec3(0.0);\n"
+		"	for (int i = 0; i < GLOBAL_LIGHTS; ++i) {\n"
+		"		if (GLOBAL_LIGHT_TYPE[i] == 1) { //hemi light \n"
+		"			e += (dot(n,-GLOBAL_LIGHT_DIRECTION[i]) * 0.5 + 0.5) * GLOBAL_LIGHT_ENERGY[i];\n"
+		"		} else { //(GLOBAL_LIGHT_TYPE[i] == 3) //directional light \n"
+		"			float nl = max(0.0, dot(n,-GLOBAL_LIGHT_DIRECTION[i]));\n"
+		"			if (GLOBAL_LIGHT_SHADOW[i] != 0 && nl > 0.0) nl *= cascade_shadow(n);\n"
+		"			e += nl * GLOBAL_LIGHT_ENERGY[i];\n"
+		"		}\n"
+		"	}\n"
+		"	int slice = int(floor(log(max(-viewPosition.z, 1e-6)) * CLUSTER_DEPTH.x + CLUSTER_DEPTH.y));\n"
+		"	if (slice >= 0 && slice < CLUSTER_COUNT.z) {\n"
+		"		ivec2 tile = clamp(ivec2(gl_FragCoord.xy / CLUSTER_TILE), ivec2(0), CLUSTER_COUNT.xy - 1);\n"
+		"		uvec2 cluster = texelFetch(CLUSTERS, (slice * CLUSTER_COUNT.y + tile.y) * CLUSTER_COUNT.x + tile.x).xy;\n"
+		"		for (uint i = cluster.x; i < cluster.x + cluster.y; ++i) {\n"
+		"			int light = 3 * int(texelFetch(CLUSTER_LIGHTS, int(i)).x);\n"
+		"			vec4 position_range = texelFetch(LIGHTS, light);\n"
+		"			vec4 direction_cutoff = texelFetch(LIGHTS, light + 1);\n"
+		"			vec4 energy_shadow = texelFetch(LIGHTS, light + 2);\n"
+		"			vec3 l = (position_range.xyz - position);\n"
+		"			float dis2 = dot(l,l);\n"
+		"			l = l * inversesqrt(max(dis2, 1e-12));\n"
+		"			float nl = max(0.0, dot(n, l)) / max(1.0, dis2);\n"
+		"			float f = dis2 / (position_range.w * position_range.w);\n"
+		"			float fade = clamp(1.0 - f * f, 0.0, 1.0);\n" //(reaches zero at the light's range)
+		"			nl *= fade * fade;\n"
+		"			if (direction_cutoff.w > -1.0) { //spot light \n"
+		"				float c = dot(l,-direction_cutoff.xyz);\n"
+		"				nl *= smoothstep(direction_cutoff.w,mix(direction_cutoff.w,1.0,0.1), c);\n"
+		"				if (energy_shadow.w >= 0.0 && nl > 0.0) nl *= spot_shadow(int(energy_shadow.w), n, sqrt(dis2));\n"
+		"			}\n"
+		"			e += nl * energy_shadow.rgb;\n"
+		"		}\n"
 		"	}\n"
 		"	vec4 albedo = texture(TEX, texCoord) * color;\n"
 		"   vec4 nonFogColor = vec4(e*albedo.rgb, albedo.a);\n"
@@ -130,22 +165,44 @@ LitColorTextureProgram::LitColorTextureProgram() {
 	OBJECT_TO_LIGHT_mat4x3 = glGetUniformLocation(program, "OBJECT_TO_LIGHT");
 	NORMAL_TO_LIGHT_mat3 = glGetUniformLocation(program, "NORMAL_TO_LIGHT");
 
-	LIGHT_TYPE_int = glGetUniformLocation(program, "LIGHT_TYPE");
-	LIGHT_LOCATION_vec3 = glGetUniformLocation(program, "LIGHT_LOCATION");
-	LIGHT_DIRECTION_vec3 = glGetUniformLocation(program, "LIGHT_DIRECTION");
-	LIGHT_ENERGY_vec3 = glGetUniformLocation(program, "LIGHT_ENERGY");
-	LIGHT_CUTOFF_float = glGetUniformLocation(program, "LIGHT_CUTOFF");
+	CLUSTER_COUNT_ivec3 = glGetUniformLocation(program, "CLUSTER_COUNT");
+	CLUSTER_TILE_vec2 = glGetUniformLocation(program, "CLUSTER_TILE");
+	CLUSTER_DEPTH_vec2 = glGetUniformLocation(program, "CLUSTER_DEPTH");
+	GLOBAL_LIGHTS_int = glGetUniformLocation(program, "GLOBAL_LIGHTS");
+	GLOBAL_LIGHT_TYPE_int_array = glGetUniformLocation(program, "GLOBAL_LIGHT_TYPE");
+	GLOBAL_LIGHT_DIRECTION_vec3_array = glGetUniformLocation(program, "GLOBAL_LIGHT_DIRECTION");
+	GLOBAL_LIGHT_ENERGY_vec3_array = glGetUniformLocation(program, "GLOBAL_LIGHT_ENERGY");
+	GLOBAL_LIGHT_SHADOW_int_array = glGetUniformLocation(program, "GLOBAL_LIGHT_SHADOW");
+
+	CASCADE_WORLD_TO_SHADOW_mat4_array = glGetUniformLocation(program, "CASCADE_WORLD_TO_SHADOW");
+	CASCADE_SPLITS_vec4 = glGetUniformLocation(program, "CASCADE_SPLITS");
+	CASCADE_TEXEL_vec4 = glGetUniformLocation(program, "CASCADE_TEXEL");
+	SPOT_WORLD_TO_SHADOW_mat4_array = glGetUniformLocation(program, "SPOT_WORLD_TO_SHADOW");
+	SPOT_SHADOW_TEXEL_float_array = glGetUniformLocation(program, "SPOT_SHADOW_TEXEL");
 
 	OBJECT_TO_VIEW_mat4x3 = glGetUniformLocation(program, "OBJECT_TO_VIEW");
 	FOG_COLOR_vec4 = glGetUniformLocation(program, "FOG_COLOR");
 
 	GLuint TEX_sampler2D = glGetUniformLocation(program, "TEX");
+	GLuint LIGHTS_samplerBuffer = glGetUniformLocation(program, "LIGHTS");
+	GLuint CLUSTERS_usamplerBuffer = glGetUniformLocation(program, "CLUSTERS");
+	GLuint CLUSTER_LIGHTS_usamplerBuffer = glGetUniformLocation(program, "CLUSTER_LIGHTS");
+	GLuint CASCADE_SHADOW_sampler2DArrayShadow = glGetUniformLocation(program, "CASCADE_SHADOW");
+	GLuint SPOT_SHADOW_sampler2DShadow = glGetUniformLocation(program, "SPOT_SHADOW");
 
 	//set TEX to always refer to texture binding zero:
 	glUseProgram(program); //bind program -- glUniform* calls refer to this program now
 
 	glUniform1i(TEX_sampler2D, 0); //set TEX to sample from GL_TEXTURE0
 
+	//the light cluster buffers go in units past the ones drawables use:
+	static_assert(uint32_t(LightsTextureUnit) >= uint32_t(Scene::Drawable::Pipeline::TextureCount), "light units don't collide with drawable textures");
+	glUniform1i(LIGHTS_samplerBuffer, LightsTextureUnit);
+	glUniform1i(CLUSTERS_usamplerBuffer, ClustersTextureUnit);
+	glUniform1i(CLUSTER_LIGHTS_usamplerBuffer, ClusterLightsTextureUnit);
+	glUniform1i(CASCADE_SHADOW_sampler2DArrayShadow, CascadeShadowTextureUnit);
+	glUniform1i(SPOT_SHADOW_sampler2DShadow, SpotShadowTextureUnit);
+
 	glUseProgram(0); //unbind program -- glUniform* calls refer to ??? now
 }
 
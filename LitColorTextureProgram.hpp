@@ -22,18 +22,37 @@ struct LitColorTextureProgram {
 	GLuint OBJECT_TO_LIGHT_mat4x3 = -1U;
 	GLuint NORMAL_TO_LIGHT_mat3 = -1U;
 
-	//lighting:
-	GLuint LIGHT_TYPE_int = -1U;
-	GLuint LIGHT_LOCATION_vec3 = -1U;
-	GLuint LIGHT_DIRECTION_vec3 = -1U;
-	GLuint LIGHT_ENERGY_vec3 = -1U;
-	GLuint LIGHT_CUTOFF_float = -1U;
+	//lighting (set by LightClusters::bind):
+	GLuint CLUSTER_COUNT_ivec3 = -1U;
+	GLuint CLUSTER_TILE_vec2 = -1U;
+	GLuint CLUSTER_DEPTH_vec2 = -1U;
+	GLuint GLOBAL_LIGHTS_int = -1U;
+	GLuint GLOBAL_LIGHT_TYPE_int_array = -1U;
+	GLuint GLOBAL_LIGHT_DIRECTION_vec3_array = -1U;
+	GLuint GLOBAL_LIGHT_ENERGY_vec3_array = -1U;
+	GLuint GLOBAL_LIGHT_SHADOW_int_array = -1U;
+
+	//shadows (set by ShadowMaps::bind):
+	GLuint CASCADE_WORLD_TO_SHADOW_mat4_array = -1U;
+	GLuint CASCADE_SPLITS_vec4 = -1U;
+	GLuint CASCADE_TEXEL_vec4 = -1U;
+	GLuint SPOT_WORLD_TO_SHADOW_mat4_array = -1U;
+	GLuint SPOT_SHADOW_TEXEL_float_array = -1U;
 
 	GLuint OBJECT_TO_VIEW_mat4x3 = -1U;
 	GLuint FOG_COLOR_vec4 = -1U;
 	
 	//Textures:
 	//TEXTURE0 - texture that is accessed by TexCoord
+	//TEXTURE4..6 - light cluster buffer textures (see LightClusters; above the units Scene::draw binds per drawable)
+	//TEXTURE7..8 - shadow maps (see ShadowMaps)
+	enum : GLuint {
+		LightsTextureUnit = 4,
+		ClustersTextureUnit = 5,
+		ClusterLightsTextureUnit = 6,
+		CascadeShadowTextureUnit = 7,
+		SpotShadowTextureUnit = 8,
+	};
 };
 
 extern Load< LitColorTextureProgram > lit_color_texture_program;
@@ -1,20 +1,105 @@
 #include "Load.hpp"
+#include "AssetCache.hpp"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <iostream>
 #include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <cassert>
 
 namespace {
-	std::array< std::list< std::function< void() > >, MaxLoadTag > &get_load_lists() {
-		static std::array< std::list< std::function< void() > >, MaxLoadTag > load_lists;
+	struct LoadEntry {
+		std::function< void() > fn; //run on the context thread (if not a job)
+		LoadJob job; //run on a worker thread (if set)
+		std::string name;
+
+		//job bookkeeping:
+		bool started = false;
+		std::promise< std::function< void() > > promise;
+		float worker_ms = 0.0f; //written by worker; read after promise is fulfilled
+	};
+
+	std::array< std::list< LoadEntry >, MaxLoadTag > &get_load_lists() {
+		static std::array< std::list< LoadEntry >, MaxLoadTag > load_lists;
 		return load_lists;
 	}
+
+	//A small pool of threads to run load jobs:
+	struct LoadWorkers {
+		LoadWorkers() {
+			//(at least two, so that file reads can overlap even on single-core machines)
+			uint32_t count = std::max(2U, std::thread::hardware_concurrency());
+			for (uint32_t i = 0; i < count; ++i) {
+				threads.emplace_back([this](){
+					std::unique_lock< std::mutex > lock(mutex);
+					while (true) {
+						while (!quit && tasks.empty()) cv.wait(lock);
+						if (tasks.empty()) break; //(only happens when quitting)
+						std::function< void() > task = std::move(tasks.front());
+						tasks.pop_front();
+						lock.unlock();
+						task();
+						lock.lock();
+					}
+				});
+			}
+		}
+		~LoadWorkers() {
+			{ //let workers finish anything queued, then exit:
+				std::unique_lock< std::mutex > lock(mutex);
+				quit = true;
+			}
+			cv.notify_all();
+			for (auto &thread : threads) {
+				thread.join();
+			}
+		}
+		void run(std::function< void() > const &task) {
+			{
+				std::unique_lock< std::mutex > lock(mutex);
+				tasks.emplace_back(task);
+			}
+			cv.notify_one();
+		}
+
+		std::mutex mutex;
+		std::condition_variable cv;
+		std::deque< std::function< void() > > tasks;
+		bool quit = false;
+		std::vector< std::thread > threads;
+	};
+
+	//(created on first use; kept around for prefetching lazy loads)
+	LoadWorkers &get_load_workers() {
+		static LoadWorkers workers;
+		return workers;
+	}
+
+	float ms_since(std::chrono::high_resolution_clock::time_point const &before) {
+		return std::chrono::duration< float, std::milli >(std::chrono::high_resolution_clock::now() - before).count();
+	}
 }
 
 void add_load_function(LoadTag tag, std::function< void() > const &fn) {
 	auto &load_lists = get_load_lists();
 	assert(tag < load_lists.size());
-	load_lists[tag].emplace_back(fn);
+	load_lists[tag].emplace_back();
+	load_lists[tag].back().fn = fn;
+}
+
+void add_load_job(LoadTag tag, LoadJob const &job, std::string const &name) {
+	auto &load_lists = get_load_lists();
+	assert(tag < load_lists.size());
+	load_lists[tag].emplace_back();
+	load_lists[tag].back().job = job;
+	load_lists[tag].back().name = name;
 }
 
 void call_load_functions() {
@@ -22,11 +107,124 @@ void call_load_functions() {
 	assert(!has_been_called && "call_load_functions should only be called *once*");
 	has_been_called = true;
 
+	auto before = std::chrono::high_resolution_clock::now();
+
+	//timing info, reported once everything is loaded:
+	struct Report {
+		std::string name;
+		float worker_ms;
+		float context_ms;
+	};
+	std::vector< Report > reports;
+
+	LoadWorkers &workers = get_load_workers();
+
 	auto &load_lists = get_load_lists();
-	for (auto &fn_list : load_lists) {
+	for (uint32_t tag = 0; tag < load_lists.size(); ++tag) {
+		auto &fn_list = load_lists[tag];
+		uint32_t index = 0;
 		while (!fn_list.empty()) {
-			(*fn_list.begin())(); //call first function in the list
+			//start any jobs that aren't running yet:
+			// (done in the loop because loading functions may add more loading functions)
+			for (auto &entry : fn_list) {
+				if (!entry.job || entry.started) continue;
+				entry.started = true;
+				LoadEntry *e = &entry; //(list nodes don't move)
+				workers.run([e](){
+					auto start = std::chrono::high_resolution_clock::now();
+					try {
+						std::function< void() > finish = e->job();
+						e->worker_ms = ms_since(start);
+						e->promise.set_value(finish);
+					} catch (...) {
+						e->promise.set_exception(std::current_exception());
+					}
+				});
+			}
+
+			LoadEntry &entry = fn_list.front();
+			Report report;
+			report.name = (entry.name.empty() ? "tag " + std::to_string(tag) + " #" + std::to_string(index) : entry.name);
+			report.worker_ms = 0.0f;
+			if (entry.job) {
+				std::function< void() > finish = entry.promise.get_future().get(); //waits for job (and re-throws its exceptions)
+				report.worker_ms = entry.worker_ms;
+				auto start = std::chrono::high_resolution_clock::now();
+				if (finish) finish();
+				report.context_ms = ms_since(start);
+			} else {
+				auto start = std::chrono::high_resolution_clock::now();
+				entry.fn(); //call function
+				report.context_ms = ms_since(start);
+			}
+			reports.emplace_back(report);
 			fn_list.pop_front(); //remove from list
+			++index;
 		}
 	}
+
+	std::cout << "Loaded " << reports.size() << " items in " << ms_since(before) << "ms:\n";
+	for (auto const &report : reports) {
+		std::cout << "  " << report.name << ": " << report.worker_ms << "ms worker + " << report.context_ms << "ms context\n";
+	}
+	std::cout.flush();
+}
+
+void watch_load(std::string const &filename, LoadThread thread, LoadJob const &job, std::string const &name) {
+	std::string label = (name.empty() ? filename : name);
+	if (thread == LoadOnWorker) {
+		//job runs on the watcher thread; its context-thread part is queued for the main thread (see Jobs::run_on_main):
+		AssetCache::watch(filename, [job,label]() -> std::function< void() > {
+			auto before = std::chrono::high_resolution_clock::now();
+			std::function< void() > finish = job();
+			std::cout << "Re-read " << label << " in " << ms_since(before) << "ms" << std::endl;
+			return finish;
+		});
+	} else {
+		//whole job needs the context thread:
+		AssetCache::watch(filename, [job,label]() -> std::function< void() > {
+			return [job,label](){
+				auto before = std::chrono::high_resolution_clock::now();
+				std::function< void() > finish = job();
+				if (finish) finish();
+				std::cout << "Reloaded " << label << " in " << ms_since(before) << "ms" << std::endl;
+			};
+		});
+	}
+}
+
+LazyLoad::LazyLoad(LoadThread thread_, LoadJob const &job_, std::string const &name_) : thread(thread_), job(job_), name(name_) {
+}
+
+void LazyLoad::prefetch() {
+	if (thread != LoadOnWorker || prefetching) return;
+	prefetching = true;
+
+	auto promise = std::make_shared< std::promise< std::function< void() > > >();
+	prefetched = promise->get_future();
+	LoadJob job_copy = job;
+	get_load_workers().run([promise,job_copy](){
+		try {
+			promise->set_value(job_copy());
+		} catch (...) {
+			promise->set_exception(std::current_exception());
+		}
+	});
+}
+
+void LazyLoad::resolve() {
+	auto before = std::chrono::high_resolution_clock::now();
+	bool was_prefetched = prefetching;
+
+	std::function< void() > finish;
+	if (prefetching) {
+		prefetching = false; //(future can only be read once; a failed load will retry from scratch)
+		finish = prefetched.get(); //waits for job (and re-throws its exceptions)
+	} else {
+		finish = job();
+	}
+	if (finish) finish();
+
+	std::cout << "Lazy-loaded " << (name.empty() ? std::string("(unnamed)") : name) << " in " << ms_since(before) << "ms"
+		<< (was_prefetched ? " (after prefetch)" : "") << std::endl;
 }
@@ -20,27 +20,84 @@
  * These functions are grouped by 'tags', which allow some sequencing of calls.
  * (particularly, this is useful for loading large data blobs [e.g. Meshes] before looking up individual elements within them.)
  *
+ * Loading functions run on the thread that owns the OpenGL context.
+ * CPU-only work (reading files, decoding, parsing) can instead run as a 'load job' on a pool of worker threads:
+ *
+ * Load< Sound::Sample > music(LoadTagDefault, LoadOnWorker, []() -> Sound::Sample const * {
+ *     return new Sound::Sample(data_path("music.opus"));
+ * });
+ *
+ * A job may hand back a function to finish up on the context thread (e.g., to upload data to OpenGL).
+ * Jobs in a tag all start once every earlier tag is finished, so a job must not use other loads from its own tag.
+ * Context-thread functions in a tag still run in the order they were added (after any jobs added before them).
+ *
+ * Loads tagged LoadTagLazy aren't loaded by call_load_functions() at all; instead they load on first use.
+ * Calling prefetch() on a lazy load (e.g., from a Mode, a few frames before the asset is needed) starts its
+ * worker part in the background, so that first use only waits for whatever is left.
+ * (lazy loads should only be used or prefetched from the context thread)
+ *
+ * Calling reload_on_change(filename) re-runs a load whenever that file's contents change (see AssetCache.hpp).
+ * The new value is swapped in between frames; the old value is not freed, since code may still hold pointers into it.
+ *
  */
 
 #include <functional>
+#include <future>
+#include <memory>
 #include <stdexcept>
+#include <string>
 
 enum LoadTag : uint32_t {
 	LoadTagEarly,
 	LoadTagDefault,
 	LoadTagLate,
-	MaxLoadTag //<-- just used to track # of load tags
+	MaxLoadTag, //<-- just used to track # of load tags
+	LoadTagLazy = MaxLoadTag //<-- not loaded by call_load_functions(); loaded on first use (or prefetch)
+};
+
+//Which thread a loading function runs on:
+enum LoadThread : uint32_t {
+	LoadOnContext, //the thread that owns the OpenGL context (required for any GL calls)
+	LoadOnWorker //a worker thread (for CPU-only work)
 };
 
 //Add a function to an internal list of loading functions:
 // (only call *before* "call_load_functions()")
 void add_load_function(LoadTag tag, std::function< void() > const &fn);
 
+//A load job runs on a worker thread and returns a (possibly empty) function to run afterward on the context thread:
+typedef std::function< std::function< void() >() > LoadJob;
+
+//Add a job to an internal list of loading jobs:
+// ('name' is used when reporting load times)
+// (only call *before* "call_load_functions()")
+void add_load_job(LoadTag tag, LoadJob const &job, std::string const &name = "");
+
 //Call all loading functions:
 // (loading functions may throw exceptions if they fail.)
 // (only call *once*)
 void call_load_functions();
 
+//Re-run a load's job whenever the contents of 'filename' change:
+// (used by Load< T >::reload_on_change(); LoadOnContext jobs run entirely on the main thread, in Jobs::run_main_jobs())
+void watch_load(std::string const &filename, LoadThread thread, LoadJob const &job, std::string const &name);
+
+
+//Bookkeeping for LoadTagLazy loads:
+struct LazyLoad {
+	LazyLoad(LoadThread thread, LoadJob const &job, std::string const &name);
+
+	//start a LoadOnWorker job in the background (does nothing if already started or if job is LoadOnContext):
+	void prefetch();
+	//finish loading (waits for prefetch, if one is in flight):
+	void resolve();
+
+	LoadThread thread;
+	LoadJob job;
+	std::string name;
+	bool prefetching = false;
+	std::future< std::function< void() > > prefetched;
+};
 
 //work-around for MSVC not accepting this as a lambda:
 template< typename T >
@@ -49,22 +106,83 @@ T const *new_T() { return new T; }
 template< typename T >
 struct Load {
 	//Constructing a Load< T > adds the passed function to the list of functions to call:
-	Load(LoadTag tag, const std::function< T const *() > &load_fn = new_T< T >) : value(nullptr) {
-		add_load_function(tag, [this,load_fn](){
-			this->value = load_fn();
-			if (!(this->value)) {
-				throw std::runtime_error("Loading failed.");
-			}
-		});
+	Load(LoadTag tag, const std::function< T const *() > &load_fn = new_T< T >) : Load(tag, LoadOnContext, load_fn) { }
+
+	//...or to the list of jobs to run on worker threads (if 'thread' is LoadOnWorker):
+	// (note: load_fn must not make any OpenGL calls when run on a worker)
+	Load(LoadTag tag, LoadThread thread, const std::function< T const *() > &load_fn, std::string const &name = "") : value(nullptr) {
+		init(tag, thread, [this,load_fn]() -> std::function< void() > {
+			T const *loaded = check(load_fn());
+			return [this,loaded](){ this->value = loaded; };
+		}, name);
+	}
+
+	//Two-stage version: 'read_fn' runs on a worker thread, then 'upload_fn' runs on the context thread:
+	Load(LoadTag tag, const std::function< T *() > &read_fn, const std::function< void(T &) > &upload_fn, std::string const &name = "") : value(nullptr) {
+		init(tag, LoadOnWorker, [this,read_fn,upload_fn]() -> std::function< void() > {
+			T *loaded = read_fn();
+			check(loaded);
+			return [this,loaded,upload_fn](){
+				upload_fn(*loaded);
+				this->value = loaded;
+			};
+		}, name);
+	}
+
+	//For LoadTagLazy loads, start loading in the background:
+	// (does nothing for other loads)
+	void prefetch() {
+		if (lazy && !value) lazy->prefetch();
+	}
+
+	//Load again (replacing 'value') whenever the contents of 'filename' change:
+	// (call after construction; multiple files may be watched, and loads watching the same file reload in the order they were registered)
+	void reload_on_change(std::string const &filename) {
+		watch_load(filename, thread, job, name);
 	}
 
 	//Make a "Load< T >" behave like a "T const *":
-	explicit operator bool() { return value != nullptr; }
-	operator T const *() { return value; }
-	T const &operator*() { return *value; }
-	T const *operator->() { return value; }
+	// (note: using a LoadTagLazy load will load it, if needed)
+	explicit operator bool() { return get() != nullptr; }
+	operator T const *() { return get(); }
+	T const &operator*() { return *get(); }
+	T const *operator->() { return get(); }
+
+	T const *get() {
+		if (lazy && !value) lazy->resolve();
+		return value;
+	}
 
 	T const *value;
+	std::unique_ptr< LazyLoad > lazy; //only used for LoadTagLazy
+
+	//kept for reload_on_change():
+	LoadThread thread = LoadOnContext;
+	LoadJob job;
+	std::string name;
+
+	static T const *check(T const *loaded) {
+		if (!loaded) {
+			throw std::runtime_error("Loading failed.");
+		}
+		return loaded;
+	}
+
+	void init(LoadTag tag, LoadThread thread_, LoadJob const &job_, std::string const &name_) {
+		thread = thread_;
+		job = job_;
+		name = name_;
+		if (tag == LoadTagLazy) {
+			lazy.reset(new LazyLoad(thread, job, name));
+		} else if (thread == LoadOnWorker) {
+			add_load_job(tag, job, name);
+		} else {
+			add_load_function(tag, [job_](){
+				std::function< void() > finish = job_();
+				if (finish) finish();
+			});
+		}
+	}
 };
 
 
@@ -77,5 +195,3 @@ struct Load< void > {
 		add_load_function(tag, load_fn);
 	}
 };
-
-
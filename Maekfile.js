@@ -121,30 +121,59 @@ if (maek.OS === 'windows') {
 // cppFile: name of c++ file to compile
 // objFileBase (optional): base name object file to produce (if not supplied, set to options.objDir + '/' + cppFile without the extension)
 //returns objFile: objFileBase + a platform-dependant suffix ('.o' or '.obj')
-const game_names = [
+//the game's modes (shared by the game and the benchmark):
+const play_names = [
 	maek.CPP('PlayMode.cpp'),
-	maek.CPP('main.cpp'),
 	maek.CPP('LitColorTextureProgram.cpp'),
+	maek.CPP('LightClusters.cpp'),
+	maek.CPP('ShadowMaps.cpp'),
+	maek.CPP('ShadowProgram.cpp'),
 	maek.CPP('ColorTextureProgram.cpp'),  //not used right now, but you might want it
 	maek.CPP('Sound.cpp'),
 	maek.CPP('Particle.cpp'),
+	maek.CPP('ParticleProgram.cpp'),
+	maek.CPP('ParticleUpdateProgram.cpp'),
 	maek.CPP('load_wav.cpp'),
 	maek.CPP('load_opus.cpp')
 ];
 
+const game_names = [
+	maek.CPP('main.cpp'),
+	...play_names
+];
+
+const benchmark_names = [
+	maek.CPP('benchmark.cpp'),
+	...play_names
+];
+
+//(Bundle is also used by the asset-bundle tool, below)
+const bundle_name = maek.CPP('Bundle.cpp');
+
 const common_names = [
 	maek.CPP('data_path.cpp'),
+	bundle_name,
 	maek.CPP('PathFont.cpp'),
 	maek.CPP('PathFont-font.cpp'),
 	maek.CPP('DrawLines.cpp'),
+	maek.CPP('StreamBuffer.cpp'),
 	maek.CPP('ColorProgram.cpp'),
+	maek.CPP('SolidColorProgram.cpp'),
+	maek.CPP('TextMesh.cpp'),
 	maek.CPP('Scene.cpp'),
+	maek.CPP('StaticBatch.cpp'),
 	maek.CPP('Mesh.cpp'),
 	maek.CPP('load_save_png.cpp'),
 	maek.CPP('gl_compile_program.cpp'),
 	maek.CPP('Mode.cpp'),
 	maek.CPP('GL.cpp'),
-	maek.CPP('Load.cpp')
+	maek.CPP('Load.cpp'),
+	maek.CPP('AssetCache.cpp'),
+	maek.CPP('Profiler.cpp'),
+	maek.CPP('Jobs.cpp'),
+	maek.CPP('FrameArena.cpp'),
+	maek.CPP('InputScript.cpp'),
+	maek.CPP('SimulationThread.cpp')
 ];
 
 const show_meshes_names = [
@@ -159,16 +188,36 @@ const show_scene_names = [
 	maek.CPP('ShowSceneMode.cpp')
 ];
 
+//(pack-meshes is a command-line tool; it doesn't need the common objects)
+const pack_meshes_names = [
+	maek.CPP('pack-meshes.cpp')
+];
+
+const asset_bundle_names = [
+	maek.CPP('asset-bundle.cpp'),
+	bundle_name
+];
+
 //the '[exeFile =] LINK(objFiles, exeFileBase, [, options])' links an array of objects into an executable:
 // objFiles: array of objects to link
 // exeFileBase: name of executable file to produce
 //returns exeFile: exeFileBase + a platform-dependant suffix (e.g., '.exe' on windows)
 const game_exe = maek.LINK([...game_names, ...common_names], 'dist/game');
+const benchmark_exe = maek.LINK([...benchmark_names, ...common_names], 'dist/benchmark');
 const show_meshes_exe = maek.LINK([...show_meshes_names, ...common_names], 'scenes/show-meshes');
 const show_scene_exe = maek.LINK([...show_scene_names, ...common_names], 'scenes/show-scene');
+const pack_meshes_exe = maek.LINK(pack_meshes_names, 'scenes/pack-meshes');
+const asset_bundle_exe = maek.LINK(asset_bundle_names, 'scenes/asset-bundle');
+
+//pack the game's assets into one file (mounted by main.cpp, if present):
+const bundled_assets = ['sub.pnct', 'sub.scene', 'ambient.opus', 'success.opus', 'sonar1.opus', 'sonar2.opus'];
+const assets_bundle = 'dist/assets.bundle';
+maek.RULE([assets_bundle], [asset_bundle_exe, ...bundled_assets.map(name => `dist/${name}`)], [
+	[asset_bundle_exe, 'pack', assets_bundle, 'dist', ...bundled_assets]
+]);
 
 //set the default target to the game (and copy the readme files):
-maek.TARGETS = [game_exe, show_meshes_exe, show_scene_exe, ...copies];
+maek.TARGETS = [game_exe, benchmark_exe, show_meshes_exe, show_scene_exe, pack_meshes_exe, asset_bundle_exe, assets_bundle, ...copies];
 
 //the '[targets =] RULE(targets, prerequisites[, recipe])' rule defines a Makefile-style task
 // targets: array of targets the task produces (can include both files and ':abstract targets')
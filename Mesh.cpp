@@ -1,5 +1,6 @@
 #include "Mesh.hpp"
 #include "read_write_chunk.hpp"
+#include "data_path.hpp"
 
 #include <glm/glm.hpp>
 
@@ -9,12 +10,12 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <algorithm>
 #include <cstddef>
 
-MeshBuffer::MeshBuffer(std::string const &filename) {
-	glGenBuffers(1, &buffer);
-
-	std::ifstream file(filename, std::ios::binary);
+MeshBuffer::MeshBuffer(std::string const &filename, UploadMode upload_mode) {
+	std::unique_ptr< std::istream > file_ptr = open_data(filename); //(may come from a mounted bundle)
+	std::istream &file = *file_ptr;
 
 	GLuint total = 0;
 
@@ -31,10 +32,12 @@ MeshBuffer::MeshBuffer(std::string const &filename) {
 	if (filename.size() >= 5 && filename.substr(filename.size()-5) == ".pnct") {
 		read_chunk(file, "pnct", &data);
 
-		//upload data:
-		glBindBuffer(GL_ARRAY_BUFFER, buffer);
-		glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(Vertex), data.data(), GL_STATIC_DRAW);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		//upload data (or hang on to it for later):
+		if (upload_mode == UploadNow) {
+			upload(data.data(), data.size() * sizeof(Vertex));
+		} else {
+			pending_data.assign(reinterpret_cast< char const * >(data.data()), reinterpret_cast< char const * >(data.data() + data.size()));
+		}
 
 		total = GLuint(data.size()); //store total for later checks on index
 
@@ -83,6 +86,49 @@ MeshBuffer::MeshBuffer(std::string const &filename) {
 		}
 	}
 
+	if (file.peek() != EOF) { //(optional) read level-of-detail chunk, add to lods (and point meshes at their levels):
+		struct LodEntry {
+			uint32_t name_begin, name_end;
+			uint32_t level;
+			uint32_t vertex_begin, vertex_end;
+			float error;
+		};
+		static_assert(sizeof(LodEntry) == 24, "LOD entry should be packed");
+
+		std::vector< LodEntry > entries;
+		read_chunk(file, "lod0", &entries);
+
+		lods.reserve(entries.size());
+		for (auto const &entry : entries) {
+			if (!(entry.name_begin <= entry.name_end && entry.name_end <= strings.size())) {
+				throw std::runtime_error("lod entry has out-of-range name begin/end");
+			}
+			if (!(entry.vertex_begin <= entry.vertex_end && entry.vertex_end <= total)) {
+				throw std::runtime_error("lod entry has out-of-range vertex start/count");
+			}
+			std::string name(&strings[0] + entry.name_begin, &strings[0] + entry.name_end);
+			auto f = meshes.find(name);
+			if (f == meshes.end()) {
+				throw std::runtime_error("lod entry for mesh '" + name + "' that isn't in the index");
+			}
+			Mesh &mesh = f->second;
+			if (entry.level != mesh.lod_count + 1) {
+				throw std::runtime_error("lod entries for mesh '" + name + "' are out of order");
+			}
+			if (mesh.lod_count == 0) {
+				mesh.lod_first = uint32_t(lods.size());
+			} else if (mesh.lod_first + mesh.lod_count != lods.size()) {
+				throw std::runtime_error("lod entries for mesh '" + name + "' aren't contiguous");
+			}
+			Mesh::LOD lod;
+			lod.start = entry.vertex_begin;
+			lod.count = entry.vertex_end - entry.vertex_begin;
+			lod.error = entry.error;
+			lods.emplace_back(lod);
+			mesh.lod_count += 1;
+		}
+	}
+
 	if (file.peek() != EOF) {
 		std::cerr << "WARNING: trailing data in mesh file '" << filename << "'" << std::endl;
 	}
@@ -98,6 +144,21 @@ MeshBuffer::MeshBuffer(std::string const &filename) {
 	*/
 }
 
+void MeshBuffer::upload() {
+	if (buffer != 0) return; //already uploaded (e.g., shared through AssetCache by another load)
+	upload(pending_data.data(), pending_data.size());
+	pending_data.clear();
+	pending_data.shrink_to_fit();
+}
+
+void MeshBuffer::upload(void const *data, size_t size) {
+	assert(buffer == 0 && "MeshBuffer data should only be uploaded once.");
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 const Mesh &MeshBuffer::lookup(std::string const &name) const {
 	auto f = meshes.find(name);
 	if (f == meshes.end()) {
@@ -106,6 +167,20 @@ const Mesh &MeshBuffer::lookup(std::string const &name) const {
 	return f->second;
 }
 
+MeshBuffer::Range MeshBuffer::lookup(std::string const &name, uint32_t level) const {
+	Mesh const &mesh = lookup(name);
+	Range range;
+	range.type = mesh.type;
+	range.start = mesh.start;
+	range.count = mesh.count;
+	if (level > 0 && mesh.lod_count > 0) {
+		Mesh::LOD const &lod = lods_of(mesh)[std::min(level, mesh.lod_count) - 1];
+		range.start = lod.start;
+		range.count = lod.count;
+	}
+	return range;
+}
+
 GLuint MeshBuffer::make_vao_for_program(GLuint program) const {
 	//create a new vertex array object:
 	GLuint vao = 0;
@@ -6,6 +6,8 @@
  * A "MeshBuffer" holds a collection of such meshes (loaded from a file) in
  *  a single OpenGL array buffer. Individual meshes can be looked up by name
  *  using the MeshBuffer::lookup() function.
+ * Meshes may also have simplified versions ("levels of detail") in the same
+ *  buffer, made by 'pack-meshes --lods=N'; see Mesh::LOD.
  *
  */
 
@@ -14,6 +16,7 @@
 #include <map>
 #include <limits>
 #include <string>
+#include <vector>
 
 
 struct Mesh {
@@ -27,16 +30,48 @@ struct Mesh {
 	//useful for debug visualization and (perhaps, eventually) collision detection:
 	glm::vec3 min = glm::vec3( std::numeric_limits< float >::infinity());
 	glm::vec3 max = glm::vec3(-std::numeric_limits< float >::infinity());
+
+	//Simplified versions of the mesh, from most to least detailed (the first is level 1; the mesh itself is level 0):
+	struct LOD {
+		GLuint start = 0;
+		GLuint count = 0;
+		float error = 0.0f; //(roughly) how far this level's surface strays from the full mesh's, in mesh units
+	};
+	//...are stored in the MeshBuffer's 'lods' array (see MeshBuffer::lods_of):
+	uint32_t lod_first = 0; //index of level 1
+	uint32_t lod_count = 0; //number of levels (0 if the file has no simplified versions of this mesh)
 };
 
 struct MeshBuffer {
 	//construct from a file:
 	// note: will throw if file fails to read.
-	MeshBuffer(std::string const &filename);
+	// note: with UploadLater, no OpenGL calls are made (so this may run on a loading thread); call upload() before use.
+	enum UploadMode { UploadNow, UploadLater };
+	MeshBuffer(std::string const &filename, UploadMode upload_mode = UploadNow);
+
+	//construct empty (e.g., to fill in attribs, meshes, and data by hand -- see StaticBatch):
+	MeshBuffer() = default;
+
+	//send data read with UploadLater to OpenGL (call from the thread with the OpenGL context):
+	// (does nothing if already uploaded)
+	void upload();
 
 	//look up a particular mesh by name:
 	// note: will throw if mesh not found.
 	const Mesh &lookup(std::string const &name) const;
+
+	//look up the vertex range of level-of-detail 'level' of a mesh (0 is the mesh itself; levels past the coarsest give the coarsest):
+	// note: will throw if mesh not found.
+	struct Range {
+		GLenum type = GL_TRIANGLES;
+		GLuint start = 0;
+		GLuint count = 0;
+	};
+	Range lookup(std::string const &name, uint32_t level) const;
+
+	//a mesh's simplified versions (mesh.lod_count of them, most detailed first):
+	// (points into 'lods', so is valid as long as this MeshBuffer is)
+	Mesh::LOD const *lods_of(Mesh const &mesh) const { return lods.data() + mesh.lod_first; }
 	
 	//build a vertex array object that links this vbo to attributes to a program:
 	// note: will throw if program defines attributes not contained in this buffer
@@ -50,6 +85,13 @@ struct MeshBuffer {
 	//used by the lookup() function:
 	std::map< std::string, Mesh > meshes;
 
+	//all meshes' simplified versions (each mesh's levels are contiguous; see Mesh::lod_first):
+	std::vector< Mesh::LOD > lods;
+
+	//vertex data waiting for upload() (only used with UploadLater):
+	std::vector< char > pending_data;
+	void upload(void const *data, size_t size);
+
 	//These 'Attrib' structures describe the location of various attributes within the buffer (in exactly format wanted by glVertexAttribPointer). They are set when the file is loaded and are used by the "make_vao_for_program" call:
 	struct Attrib {
 		GLint size = 0;
@@ -1,8 +1,41 @@
 #include "Mode.hpp"
 
+#include <cassert>
+#include <cmath>
+
 std::shared_ptr< Mode > Mode::current;
+uint32_t Mode::updates = 0;
 
 void Mode::set_current(std::shared_ptr< Mode > const &new_current) {
 	current = new_current;
 	//NOTE: may wish to, e.g., trigger resize events on new current mode.
 }
+
+void Mode::update_current(float elapsed) {
+	assert(current);
+	if (current->fixed_timestep <= 0.0f) {
+		updates += 1;
+		current->update(elapsed);
+		return;
+	}
+
+	//fixed-rate modes get as many whole steps as have elapsed:
+	static float accumulator = 0.0f;
+	accumulator += elapsed;
+	std::shared_ptr< Mode > mode = current;
+	for (uint32_t step = 0; accumulator >= mode->fixed_timestep; ++step) {
+		if (step == MaxStepsPerFrame) {
+			accumulator = std::fmod(accumulator, mode->fixed_timestep);
+			break;
+		}
+		updates += 1;
+		mode->update(mode->fixed_timestep);
+		accumulator -= mode->fixed_timestep;
+		if (current != mode) {
+			//(new mode starts its own timeline)
+			accumulator = 0.0f;
+			return;
+		}
+	}
+	mode->interpolate(accumulator / mode->fixed_timestep);
+}
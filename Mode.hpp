@@ -3,6 +3,7 @@
 #include <SDL.h>
 #include <glm/glm.hpp>
 
+#include <cstdint>
 #include <memory>
 
 struct Mode : std::enable_shared_from_this< Mode > {
@@ -17,6 +18,23 @@ struct Mode : std::enable_shared_from_this< Mode > {
 	// 'elapsed' is time in seconds since the last call to 'update'
 	virtual void update(float elapsed) { }
 
+	//modes that set 'fixed_timestep' (in seconds) are simulated at a fixed rate instead:
+	// update is called zero or more times per frame, always with elapsed == fixed_timestep,
+	// and then interpolate is called (before draw) with the fraction of a step that has
+	// elapsed since the most recent update, so drawing can blend between the last two steps.
+	float fixed_timestep = 0.0f;
+	virtual void interpolate(float alpha) { }
+
+	//at most this many fixed steps are run per frame (extra time is dropped, so slow updates can't snowball):
+	static constexpr uint32_t MaxStepsPerFrame = 5;
+
+	//fixed-rate modes that set 'threaded_update_ok' may have handle_event and update run on
+	// a separate thread (see SimulationThread.hpp) while interpolate and draw run on the main thread.
+	// Such modes must:
+	//  - hand anything draw needs over from update through a lock-free structure (e.g., TripleBuffer.hpp)
+	//  - not make OpenGL calls, SDL video calls (window, mouse mode, ...), use lazy Loads, or call set_current from handle_event or update
+	bool threaded_update_ok = false;
+
 	//draw is called after update:
 	virtual void draw(glm::uvec2 const &drawable_size) = 0;
 
@@ -24,5 +42,13 @@ struct Mode : std::enable_shared_from_this< Mode > {
 	// use 'set_current' to change the current Mode (e.g., to switch to a menu)
 	static std::shared_ptr< Mode > current;
 	static void set_current(std::shared_ptr< Mode > const &);
+
+	//advance Mode::current by 'elapsed' seconds (main loops call this once per frame):
+	// calls update(elapsed) -- or, for fixed-rate modes, runs whole steps and then calls interpolate.
+	// (update may change Mode::current, or set it to null)
+	static void update_current(float elapsed);
+
+	//number of update calls update_current has made so far (input scripts are keyed on this; see InputScript.hpp):
+	static uint32_t updates;
 };
 
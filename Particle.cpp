@@ -0,0 +1,243 @@
+#include "Particle.hpp"
+
+#include "ParticleProgram.hpp"
+#include "ParticleUpdateProgram.hpp"
+#include "Jobs.hpp"
+#include "Profiler.hpp"
+#include "gl_errors.hpp"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+//blocks handled by each job in update() and pack():
+static constexpr uint32_t BlocksPerJob = 64;
+
+static inline uint32_t xorshift32(uint32_t x) {
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return x;
+}
+
+//random value in [0,1):
+static inline float unit(uint32_t x) {
+	return float(x >> 8) * (1.0f / float(1 << 24));
+}
+
+//initial random state of particle 'index' (a hash of seed and index, so each particle gets its own stream):
+static uint32_t initial_random(uint32_t seed, uint32_t index) {
+	uint32_t h = seed + 0x9e3779b9u * (index + 1);
+	h = (h ^ (h >> 16)) * 0x85ebca6bu;
+	h = (h ^ (h >> 13)) * 0xc2b2ae35u;
+	h ^= h >> 16;
+	return (h ? h : 1); //(xorshift32 gets stuck at zero)
+}
+
+Particles::Particles(uint32_t count_, uint32_t seed) : count(count_) {
+	blocks.resize((count + Lanes - 1) / Lanes);
+
+	uint32_t index = 0;
+	for (auto &block : blocks) {
+		for (uint32_t l = 0; l < Lanes; ++l) {
+			block.random[l] = initial_random(seed, index++);
+
+			block.x[l] = block.y[l] = block.z[l] = 0.0f;
+			block.t[l] = 0.0f;
+			block.life[l] = 0.0f;
+			block.radius[l] = 0.0f;
+		}
+	}
+}
+
+void Particles::update(float elapsed, ParticleEmitter const &emitter) {
+	//(copied to locals so the compiler knows stores to blocks can't change them)
+	glm::vec3 const center = emitter.center;
+	float const spread = emitter.spread;
+	float const rise = emitter.rise * elapsed;
+	float const max_life = emitter.max_life;
+	float const grow = emitter.grow;
+
+	Jobs::parallel_for(0, uint32_t(blocks.size()), BlocksPerJob, [&](uint32_t first, uint32_t last) {
+		for (uint32_t b = first; b < last; ++b) {
+			Block &block = blocks[b];
+
+			//respawn expired particles:
+			// (every lane computes a spawn, then lanes that didn't need one keep their old values -- one select per
+			//  loop, with no arithmetic behind the selects, is what compilers reliably turn into SIMD blends at -O2)
+			float x[Lanes], y[Lanes], z[Lanes], life[Lanes];
+			for (uint32_t l = 0; l < Lanes; ++l) {
+				uint32_t r0 = xorshift32(block.random[l]);
+				uint32_t r1 = xorshift32(r0);
+				uint32_t r2 = xorshift32(r1);
+				uint32_t r3 = xorshift32(r2);
+				x[l] = center.x + (unit(r0) - 0.5f) * spread;
+				y[l] = center.y + (unit(r1) - 0.5f) * spread;
+				z[l] = center.z + (unit(r2) - 0.5f) * spread;
+				life[l] = unit(r3) * max_life;
+				block.random[l] = r3; //(streams advance every update, spawn or not)
+			}
+			for (uint32_t l = 0; l < Lanes; ++l) block.x[l] = (block.t[l] == 0.0f ? x[l] : block.x[l]);
+			for (uint32_t l = 0; l < Lanes; ++l) block.y[l] = (block.t[l] == 0.0f ? y[l] : block.y[l]);
+			for (uint32_t l = 0; l < Lanes; ++l) block.z[l] = (block.t[l] == 0.0f ? z[l] : block.z[l]);
+			for (uint32_t l = 0; l < Lanes; ++l) block.life[l] = (block.t[l] == 0.0f ? life[l] : block.life[l]);
+
+			//rise, age, and scale in/out:
+			for (uint32_t l = 0; l < Lanes; ++l) {
+				float t = block.t[l] + elapsed;
+				block.z[l] += rise;
+				block.radius[l] = std::max(0.0f, grow * std::min(t, block.life[l] - t));
+				block.t[l] = (t >= block.life[l] ? 0.0f : t);
+			}
+		}
+	});
+}
+
+void Particles::pack(std::vector< glm::vec4 > *instances_) const {
+	assert(instances_);
+	auto &instances = *instances_;
+
+	instances.resize(blocks.size() * Lanes);
+	Jobs::parallel_for(0, uint32_t(blocks.size()), BlocksPerJob, [&](uint32_t first, uint32_t last) {
+		for (uint32_t b = first; b < last; ++b) {
+			Block const &block = blocks[b];
+			glm::vec4 *out = &instances[b * Lanes];
+			for (uint32_t l = 0; l < Lanes; ++l) {
+				out[l] = glm::vec4(block.x[l], block.y[l], block.z[l], block.radius[l]);
+			}
+		}
+	});
+	instances.resize(count); //(drop the unused end of the last block; shrinking doesn't reallocate)
+}
+
+GPUParticles::GPUParticles(uint32_t count_, uint32_t seed) : count(count_) {
+	std::vector< State > initial(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		initial[i].position = glm::vec3(0.0f);
+		initial[i].radius = 0.0f;
+		initial[i].t = 0.0f;
+		initial[i].life = 0.0f;
+		initial[i].random = initial_random(seed, i);
+	}
+
+	glGenBuffers(2, buffers.data());
+	glGenVertexArrays(2, vaos.data());
+	for (uint32_t i = 0; i < 2; ++i) {
+		glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+		//(GL_STREAM_COPY: written by the GPU every frame, read by the GPU)
+		glBufferData(GL_ARRAY_BUFFER, initial.size() * sizeof(State), initial.data(), GL_STREAM_COPY);
+
+		glBindVertexArray(vaos[i]);
+		glVertexAttribPointer(particle_update_program->Position_vec3, 3, GL_FLOAT, GL_FALSE, sizeof(State), (GLbyte *)0 + offsetof(State, position));
+		glEnableVertexAttribArray(particle_update_program->Position_vec3);
+		glVertexAttribPointer(particle_update_program->T_float, 1, GL_FLOAT, GL_FALSE, sizeof(State), (GLbyte *)0 + offsetof(State, t));
+		glEnableVertexAttribArray(particle_update_program->T_float);
+		glVertexAttribPointer(particle_update_program->Life_float, 1, GL_FLOAT, GL_FALSE, sizeof(State), (GLbyte *)0 + offsetof(State, life));
+		glEnableVertexAttribArray(particle_update_program->Life_float);
+		glVertexAttribIPointer(particle_update_program->Random_uint, 1, GL_UNSIGNED_INT, sizeof(State), (GLbyte *)0 + offsetof(State, random));
+		glEnableVertexAttribArray(particle_update_program->Random_uint);
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	GL_ERRORS();
+}
+
+GPUParticles::~GPUParticles() {
+	glDeleteVertexArrays(2, vaos.data());
+	glDeleteBuffers(2, buffers.data());
+	vaos.fill(0);
+	buffers.fill(0);
+}
+
+void GPUParticles::update(float elapsed, ParticleEmitter const &emitter) {
+	if (count == 0) return;
+
+	glUseProgram(particle_update_program->program);
+	glUniform1f(particle_update_program->ELAPSED_float, elapsed);
+	glUniform3fv(particle_update_program->CENTER_vec3, 1, glm::value_ptr(emitter.center));
+	glUniform1f(particle_update_program->SPREAD_float, emitter.spread);
+	glUniform1f(particle_update_program->RISE_float, emitter.rise);
+	glUniform1f(particle_update_program->MAX_LIFE_float, emitter.max_life);
+	glUniform1f(particle_update_program->GROW_float, emitter.grow);
+
+	//read from buffers[current], capture into the other one:
+	glBindVertexArray(vaos[current]);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffers[1 - current]);
+
+	glEnable(GL_RASTERIZER_DISCARD);
+	glBeginTransformFeedback(GL_POINTS);
+	glDrawArrays(GL_POINTS, 0, GLsizei(count));
+	Profiler::count_draw_call();
+	glEndTransformFeedback();
+	glDisable(GL_RASTERIZER_DISCARD);
+
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+	glBindVertexArray(0);
+	glUseProgram(0);
+
+	current = 1 - current;
+
+	GL_ERRORS();
+}
+
+void GPUParticles::draw(ParticleRenderer &renderer, Scene::Camera const &camera) const {
+	renderer.draw(buffers[current], offsetof(State, position), sizeof(State), count, camera);
+}
+
+ParticleRenderer::ParticleRenderer() : stream(1 << 21) {
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+	glEnableVertexAttribArray(particle_program->Instance_vec4);
+	glVertexAttribDivisor(particle_program->Instance_vec4, 1);
+	glBindVertexArray(0);
+	GL_ERRORS();
+}
+
+ParticleRenderer::~ParticleRenderer() {
+	glDeleteVertexArrays(1, &vao);
+	vao = 0;
+}
+
+void ParticleRenderer::draw(glm::vec4 const *instances, uint32_t count, Scene::Camera const &camera) {
+	if (count == 0) return;
+
+	GLintptr offset = stream.write(instances, GLsizeiptr(count) * sizeof(glm::vec4));
+	draw(stream.buffer, offset, sizeof(glm::vec4), count, camera);
+}
+
+void ParticleRenderer::draw(GLuint buffer, GLintptr offset, GLsizei stride, uint32_t count, Scene::Camera const &camera) {
+	if (count == 0) return;
+
+	//instances move around (in the stream, or between GPUParticles' buffers), so point the attribute at this frame's:
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glVertexAttribPointer(particle_program->Instance_vec4, 4, GL_FLOAT, GL_FALSE, stride, (GLbyte *)0 + offset);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glm::mat4x3 world_to_view = camera.transform->make_world_to_local();
+	glm::mat4 world_to_clip = camera.make_projection() * glm::mat4(world_to_view);
+	glm::mat4x3 view_to_world = camera.transform->make_local_to_world();
+	glm::vec3 right = glm::normalize(view_to_world[0]);
+	glm::vec3 up = glm::normalize(view_to_world[1]);
+
+	glUseProgram(particle_program->program);
+	glUniformMatrix4fv(particle_program->WORLD_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(world_to_clip));
+	glUniformMatrix4x3fv(particle_program->WORLD_TO_VIEW_mat4x3, 1, GL_FALSE, glm::value_ptr(world_to_view));
+	glUniform3fv(particle_program->CAMERA_RIGHT_vec3, 1, glm::value_ptr(right));
+	glUniform3fv(particle_program->CAMERA_UP_vec3, 1, glm::value_ptr(up));
+	glUniform4fv(particle_program->COLOR_vec4, 1, glm::value_ptr(color));
+	glUniform3fv(particle_program->LIGHT_DIRECTION_vec3, 1, glm::value_ptr(light_direction));
+	glUniform3fv(particle_program->LIGHT_ENERGY_vec3, 1, glm::value_ptr(light_energy));
+	glUniform4fv(particle_program->FOG_COLOR_vec4, 1, glm::value_ptr(fog_color));
+
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(count));
+	Profiler::count_draw_call();
+
+	glUseProgram(0);
+	glBindVertexArray(0);
+
+	GL_ERRORS();
+}
@@ -1,7 +1,125 @@
+#pragma once
+
+/*
+ * Particles are simulated in bulk and drawn as camera-facing billboards:
+ *
+ *  - Particles holds the simulation state structure-of-arrays style, in blocks
+ *    of 'Lanes' particles (one array per field per block), so that update()'s
+ *    fixed-length, branch-free inner loops compile to SIMD code. Blocks are
+ *    split over the job system, and nothing in update() touches OpenGL, so it
+ *    is fine to run on the simulation thread.
+ *  - pack() writes the particles out as (position, radius) instances.
+ *  - GPUParticles is the same simulation run on the GPU instead: a vertex
+ *    shader (ParticleUpdateProgram) updates every particle, and transform
+ *    feedback captures the results, ping-ponging between two buffers. The CPU
+ *    only supplies the emitter parameters, and the state never leaves the GPU.
+ *  - ParticleRenderer draws instances with a single instanced draw call (the
+ *    four corners of each billboard are generated in the vertex shader).
+ *
+ * Each particle has its own random number state, so results depend only on the
+ * seed (not on how blocks were split between threads). Both backends use the
+ * same random streams and update rules.
+ *
+ */
+
+#include "GL.hpp"
 #include "Scene.hpp"
+#include "StreamBuffer.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+enum class ParticleBackend {
+	CPU, //Particles
+	GPU, //GPUParticles
+};
+
+//Where and how particles (re)spawn and move:
+struct ParticleEmitter {
+	glm::vec3 center = glm::vec3(0.0f); //particles spawn in a cube around this point...
+	float spread = 15.0f; //...this wide
+	float rise = 3.0f; //upward speed (units / second)
+	float max_life = 3.0f; //lifetimes are uniform in [0, max_life) seconds
+	float grow = 0.1f; //radius grows at this rate (units / second) for the first half of each life, then shrinks
+};
+
+struct Particles {
+	Particles(uint32_t count, uint32_t seed);
+
+	//advance every particle by 'elapsed' seconds (respawning those that have expired):
+	void update(float elapsed, ParticleEmitter const &emitter);
+
+	//replace 'instances' with (position, radius) of every particle:
+	// (particles that haven't spawned yet have radius zero)
+	void pack(std::vector< glm::vec4 > *instances) const;
+
+	uint32_t count = 0;
+
+	static constexpr uint32_t Lanes = 8; //particles per block (enough to fill an AVX register)
+	struct Block {
+		float x[Lanes], y[Lanes], z[Lanes]; //position
+		float t[Lanes]; //age (zero means "spawn on next update")
+		float life[Lanes]; //age at which to respawn
+		float radius[Lanes];
+		uint32_t random[Lanes]; //xorshift32 state (never zero)
+	};
+	std::vector< Block > blocks; //(the last block may be partly unused)
+};
+
+struct ParticleRenderer;
+
+//Particles, simulated with transform feedback:
+// (only use from the main (OpenGL context) thread)
+struct GPUParticles {
+	GPUParticles(uint32_t count, uint32_t seed);
+	~GPUParticles();
+	GPUParticles(GPUParticles const &) = delete;
+	GPUParticles &operator=(GPUParticles const &) = delete;
+
+	//advance every particle by 'elapsed' seconds (one GL_POINTS draw with rasterization off):
+	void update(float elapsed, ParticleEmitter const &emitter);
+
+	//draw the current state (without reading it back):
+	void draw(ParticleRenderer &renderer, Scene::Camera const &camera) const;
+
+	//per-particle state, as stored in the buffers:
+	// (starts with (position, radius), so ParticleRenderer can use it as an instance directly)
+	struct State {
+		glm::vec3 position;
+		float radius;
+		float t; //age (zero means "spawn on next update")
+		float life;
+		uint32_t random; //xorshift32 state
+	};
+	static_assert(sizeof(State) == 28, "State is tightly packed, to match transform feedback output.");
+
+	uint32_t count = 0;
+	std::array< GLuint, 2 > buffers{}; //state is read from buffers[current], written to the other
+	std::array< GLuint, 2 > vaos{}; //vaos[i] reads buffers[i] for ParticleUpdateProgram
+	uint32_t current = 0;
+};
+
+//Draws (position, radius) instances as round, hemisphere-lit billboards:
+// (only use from the main (OpenGL context) thread)
+struct ParticleRenderer {
+	ParticleRenderer();
+	~ParticleRenderer();
+	ParticleRenderer(ParticleRenderer const &) = delete;
+	ParticleRenderer &operator=(ParticleRenderer const &) = delete;
+
+	void draw(glm::vec4 const *instances, uint32_t count, Scene::Camera const &camera);
+	//draw instances already in 'buffer' (each a (position, radius) vec4, 'stride' bytes apart):
+	void draw(GLuint buffer, GLintptr offset, GLsizei stride, uint32_t count, Scene::Camera const &camera);
+
+	//shading (matches the hemisphere light and fog of lit_color_texture_program by default):
+	glm::vec4 color = glm::vec4(0.8f, 0.9f, 1.0f, 1.0f);
+	glm::vec3 light_direction = glm::vec3(0.0f, 1.0f,-1.0f);
+	glm::vec3 light_energy = glm::vec3(0.1f);
+	glm::vec4 fog_color = glm::vec4(0.0f);
 
-struct Particle {
-	Scene::Transform *transform;
-	float t;
-	float maxT;
+	StreamBuffer stream; //instances are copied here each frame
+	GLuint vao = 0;
 };
@@ -0,0 +1,66 @@
+#include "ParticleProgram.hpp"
+
+#include "gl_compile_program.hpp"
+#include "gl_errors.hpp"
+
+Load< ParticleProgram > particle_program(LoadTagEarly);
+
+ParticleProgram::ParticleProgram() {
+	program = gl_compile_program(
+		//vertex shader:
+		// (no per-vertex attributes: the corners of each billboard come from gl_VertexID, drawn as a 4-vertex strip)
+		"#version 330\n"
+		"uniform mat4 WORLD_TO_CLIP;\n"
+		"uniform mat4x3 WORLD_TO_VIEW;\n"
+		"uniform vec3 CAMERA_RIGHT;\n"
+		"uniform vec3 CAMERA_UP;\n"
+		"in vec4 Instance;\n"
+		"out vec2 corner;\n"
+		"out vec3 viewPosition;\n"
+		"void main() {\n"
+		"	corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1)) * 2.0 - 1.0;\n"
+		"	vec3 position = Instance.xyz + Instance.w * (corner.x * CAMERA_RIGHT + corner.y * CAMERA_UP);\n"
+		"	gl_Position = WORLD_TO_CLIP * vec4(position, 1.0);\n"
+		"	viewPosition = WORLD_TO_VIEW * vec4(position, 1.0);\n"
+		"}\n"
+	,
+		//fragment shader:
+		"#version 330\n"
+		"uniform vec3 CAMERA_RIGHT;\n"
+		"uniform vec3 CAMERA_UP;\n"
+		"uniform vec4 COLOR;\n"
+		"uniform vec3 LIGHT_DIRECTION;\n"
+		"uniform vec3 LIGHT_ENERGY;\n"
+		"uniform vec4 FOG_COLOR;\n"
+		"in vec2 corner;\n"
+		"in vec3 viewPosition;\n"
+		"out vec4 fragColor;\n"
+		"void main() {\n"
+		"	float r2 = dot(corner, corner);\n"
+		"	if (r2 > 1.0) discard;\n"
+		"	vec3 n = corner.x * CAMERA_RIGHT + corner.y * CAMERA_UP + sqrt(1.0 - r2) * cross(CAMERA_RIGHT, CAMERA_UP);\n"
+		"	vec3 e = (dot(n,-LIGHT_DIRECTION) * 0.5 + 0.5) * LIGHT_ENERGY;\n"
+		"	vec4 nonFogColor = vec4(e * COLOR.rgb, COLOR.a);\n"
+		"	float distance = length(viewPosition);\n"
+		"	fragColor = mix(nonFogColor, FOG_COLOR, min(1.0, (distance * distance) / 2000.0f));\n"
+		"}\n"
+	);
+
+	//look up the locations of vertex attributes:
+	Instance_vec4 = glGetAttribLocation(program, "Instance");
+
+	//look up the locations of uniforms:
+	WORLD_TO_CLIP_mat4 = glGetUniformLocation(program, "WORLD_TO_CLIP");
+	WORLD_TO_VIEW_mat4x3 = glGetUniformLocation(program, "WORLD_TO_VIEW");
+	CAMERA_RIGHT_vec3 = glGetUniformLocation(program, "CAMERA_RIGHT");
+	CAMERA_UP_vec3 = glGetUniformLocation(program, "CAMERA_UP");
+	COLOR_vec4 = glGetUniformLocation(program, "COLOR");
+	LIGHT_DIRECTION_vec3 = glGetUniformLocation(program, "LIGHT_DIRECTION");
+	LIGHT_ENERGY_vec3 = glGetUniformLocation(program, "LIGHT_ENERGY");
+	FOG_COLOR_vec4 = glGetUniformLocation(program, "FOG_COLOR");
+}
+
+ParticleProgram::~ParticleProgram() {
+	glDeleteProgram(program);
+	program = 0;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "GL.hpp"
+#include "Load.hpp"
+
+//Shader program that draws instanced, camera-facing billboards as hemisphere-lit spheres (used by ParticleRenderer):
+struct ParticleProgram {
+	ParticleProgram();
+	~ParticleProgram();
+
+	GLuint program = 0;
+	//Attribute (per-instance variable) locations:
+	GLuint Instance_vec4 = -1U; //xyz: center, w: radius
+	//Uniform (per-invocation variable) locations:
+	GLuint WORLD_TO_CLIP_mat4 = -1U;
+	GLuint WORLD_TO_VIEW_mat4x3 = -1U;
+	GLuint CAMERA_RIGHT_vec3 = -1U;
+	GLuint CAMERA_UP_vec3 = -1U;
+	GLuint COLOR_vec4 = -1U;
+	GLuint LIGHT_DIRECTION_vec3 = -1U;
+	GLuint LIGHT_ENERGY_vec3 = -1U;
+	GLuint FOG_COLOR_vec4 = -1U;
+};
+
+extern Load< ParticleProgram > particle_program;
@@ -0,0 +1,75 @@
+#include "ParticleUpdateProgram.hpp"
+
+#include "gl_compile_program.hpp"
+#include "gl_errors.hpp"
+
+Load< ParticleUpdateProgram > particle_update_program(LoadTagEarly);
+
+ParticleUpdateProgram::ParticleUpdateProgram() {
+	program = gl_compile_feedback_program(
+		//vertex shader:
+		"#version 330\n"
+		"uniform float ELAPSED;\n"
+		"uniform vec3 CENTER;\n"
+		"uniform float SPREAD;\n"
+		"uniform float RISE;\n"
+		"uniform float MAX_LIFE;\n"
+		"uniform float GROW;\n"
+		"in vec3 Position;\n"
+		"in float T;\n"
+		"in float Life;\n"
+		"in uint Random;\n"
+		"out vec3 position;\n"
+		"out float radius;\n"
+		"out float t;\n"
+		"out float life;\n"
+		"flat out uint random;\n"
+		"uint xorshift32(uint x) {\n"
+		"	x ^= x << 13u;\n"
+		"	x ^= x >> 17u;\n"
+		"	x ^= x << 5u;\n"
+		"	return x;\n"
+		"}\n"
+		"float unit(uint x) {\n"
+		"	return float(x >> 8u) * (1.0 / 16777216.0);\n"
+		"}\n"
+		"void main() {\n"
+		//respawn expired particles:
+		"	uint r0 = xorshift32(Random);\n"
+		"	uint r1 = xorshift32(r0);\n"
+		"	uint r2 = xorshift32(r1);\n"
+		"	uint r3 = xorshift32(r2);\n"
+		"	bool spawn = (T == 0.0);\n"
+		"	vec3 p = spawn ? CENTER + (vec3(unit(r0), unit(r1), unit(r2)) - 0.5) * SPREAD : Position;\n"
+		"	life = spawn ? unit(r3) * MAX_LIFE : Life;\n"
+		"	random = r3;\n"
+		//rise, age, and scale in/out:
+		"	float age = T + ELAPSED;\n"
+		"	position = p + vec3(0.0, 0.0, RISE * ELAPSED);\n"
+		"	radius = max(0.0, GROW * min(age, life - age));\n"
+		"	t = (age >= life ? 0.0 : age);\n"
+		"}\n"
+	,
+		//captured outputs, in GPUParticles::State order:
+		{ "position", "radius", "t", "life", "random" }
+	);
+
+	//look up the locations of vertex attributes:
+	Position_vec3 = glGetAttribLocation(program, "Position");
+	T_float = glGetAttribLocation(program, "T");
+	Life_float = glGetAttribLocation(program, "Life");
+	Random_uint = glGetAttribLocation(program, "Random");
+
+	//look up the locations of uniforms:
+	ELAPSED_float = glGetUniformLocation(program, "ELAPSED");
+	CENTER_vec3 = glGetUniformLocation(program, "CENTER");
+	SPREAD_float = glGetUniformLocation(program, "SPREAD");
+	RISE_float = glGetUniformLocation(program, "RISE");
+	MAX_LIFE_float = glGetUniformLocation(program, "MAX_LIFE");
+	GROW_float = glGetUniformLocation(program, "GROW");
+}
+
+ParticleUpdateProgram::~ParticleUpdateProgram() {
+	glDeleteProgram(program);
+	program = 0;
+}
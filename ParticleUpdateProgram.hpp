@@ -0,0 +1,29 @@
+#pragma once
+
+#include "GL.hpp"
+#include "Load.hpp"
+
+//Vertex-shader-only program that advances particles with transform feedback (used by GPUParticles):
+// each input vertex is one particle's state; the updated state is captured as
+// (position, radius, t, life, random) -- i.e., GPUParticles::State -- with rasterization off.
+// (mirrors Particles::update in Particle.cpp; keep the two in sync)
+struct ParticleUpdateProgram {
+	ParticleUpdateProgram();
+	~ParticleUpdateProgram();
+
+	GLuint program = 0;
+	//Attribute (per-vertex variable) locations:
+	GLuint Position_vec3 = -1U;
+	GLuint T_float = -1U;
+	GLuint Life_float = -1U;
+	GLuint Random_uint = -1U; //(use glVertexAttribIPointer)
+	//Uniform (per-invocation variable) locations:
+	GLuint ELAPSED_float = -1U;
+	GLuint CENTER_vec3 = -1U;
+	GLuint SPREAD_float = -1U;
+	GLuint RISE_float = -1U;
+	GLuint MAX_LIFE_float = -1U;
+	GLuint GROW_float = -1U;
+};
+
+extern Load< ParticleUpdateProgram > particle_update_program;
@@ -4,15 +4,18 @@
 #include "PathFont.hpp"
 
 #include <iostream>
+#include <cassert>
 
 PathFont::PathFont(uint32_t glyphs_,
 	const float *glyph_widths_,
 	const uint32_t *glyph_char_starts_, const uint8_t *chars_,
-	const uint32_t *glyph_coord_starts_, const float *coords_
+	const uint32_t *glyph_coord_starts_, const float *coords_,
+	const uint32_t *byte_nodes_, const TrieNode *trie_nodes_, const TrieEdge *trie_edges_
 	) : glyphs(glyphs_),
 		glyph_widths(glyph_widths_),
 		glyph_char_starts(glyph_char_starts_), chars(chars_),
-		glyph_coord_starts(glyph_coord_starts_), coords(coords_) {
+		glyph_coord_starts(glyph_coord_starts_), coords(coords_),
+		byte_nodes(byte_nodes_), trie_nodes(trie_nodes_), trie_edges(trie_edges_) {
 
 	for (uint32_t i = 0; i < glyphs; ++i) {
 		std::string str(reinterpret_cast< const char * >(chars + glyph_char_starts[i]), reinterpret_cast< const char * >(chars + glyph_char_starts[i+1]));
@@ -22,3 +25,66 @@ PathFont::PathFont(uint32_t glyphs_,
 		}
 	}
 }
+
+uint32_t PathFont::match(char const *begin, char const *end, uint32_t *length) const {
+	uint32_t glyph = -1U;
+	uint32_t matched = 0;
+	if (begin < end) {
+		uint32_t node = byte_nodes[uint8_t(*begin)];
+		uint32_t at = 1; //bytes consumed to reach 'node'
+		while (node != -1U) {
+			if (trie_nodes[node].glyph != -1U) {
+				glyph = trie_nodes[node].glyph;
+				matched = at;
+			}
+			if (begin + at == end) break;
+			uint8_t next = uint8_t(begin[at]);
+			uint32_t child = -1U;
+			for (uint32_t e = trie_nodes[node].edge_begin; e < trie_nodes[node].edge_end; ++e) {
+				if (trie_edges[e].byte == next) {
+					child = trie_edges[e].node;
+					break;
+				}
+			}
+			node = child;
+			at += 1;
+		}
+	}
+	if (length) *length = matched;
+	return glyph;
+}
+
+float PathFont::layout(std::string_view text, frame_vector< glm::vec2 > *lines_) const {
+	assert(lines_);
+	auto &lines = *lines_;
+
+	float advance = 0.0f;
+
+	char const *start = text.data();
+	char const *end = text.data() + text.size();
+	while (start < end) {
+		uint32_t length = 0;
+		uint32_t glyph = match(start, end, &length);
+		if (glyph == -1U) {
+			length = 1;
+			//missing! draw a tofu:
+			for (const auto &pt : {
+				glm::vec2(0.1f, 0.1f), glm::vec2(0.6f, 0.1f),
+				glm::vec2(0.6f, 0.1f), glm::vec2(0.6f, 0.9f),
+				glm::vec2(0.9f, 0.6f), glm::vec2(0.1f, 0.9f),
+				glm::vec2(0.1f, 0.9f), glm::vec2(0.1f, 0.1f)
+			}) {
+				lines.emplace_back(advance + pt.x, pt.y);
+			}
+			advance += 0.6f;
+		} else {
+			for (uint32_t c = glyph_coord_starts[glyph]; c + 1 < glyph_coord_starts[glyph+1]; c += 2) {
+				lines.emplace_back(advance + coords[c], coords[c+1]);
+			}
+			advance += glyph_widths[glyph];
+		}
+		start += length;
+	}
+
+	return advance;
+}
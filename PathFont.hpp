@@ -8,18 +8,32 @@
  *
  */
 
+#include "FrameArena.hpp"
+
 #include <glm/glm.hpp>
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 
 struct PathFont {
+	//lookup tables (generated along with the rest of the font data by make-PathFont-font.py):
+	struct TrieNode {
+		uint32_t glyph; //glyph whose chars end at this node (or -1U)
+		uint32_t edge_begin, edge_end; //outgoing edges, as a range in 'trie_edges'
+	};
+	struct TrieEdge {
+		uint8_t byte; //next byte of chars
+		uint32_t node; //node it leads to
+	};
+
 	//meant to be intitialized with some pointers to constant data:
 	PathFont(uint32_t glyphs,
 		const float *glyph_widths,
 		const uint32_t *glyph_char_starts, const uint8_t *chars,
-		const uint32_t *glyph_coord_starts, const float *coords
+		const uint32_t *glyph_coord_starts, const float *coords,
+		const uint32_t *byte_nodes, const TrieNode *trie_nodes, const TrieEdge *trie_edges
 		);
 	const uint32_t glyphs = 0;
 	const float *glyph_widths = nullptr;
@@ -30,7 +44,21 @@ struct PathFont {
 	const uint32_t *glyph_coord_starts = nullptr; //indices into 'coords' table
 	const float *coords = nullptr;
 
-	//computed in constructor:
+	const uint32_t *byte_nodes = nullptr; //256 entries: trie node for each first byte (or -1U)
+	const TrieNode *trie_nodes = nullptr;
+	const TrieEdge *trie_edges = nullptr;
+
+	//find the glyph whose chars are the longest prefix of [begin,end):
+	// returns the glyph index (or -1U if none match) and sets *length to the number of bytes it covers.
+	uint32_t match(char const *begin, char const *end, uint32_t *length) const;
+
+	//lay out a string as line segments (pairs of points), advancing along +x from the origin with characters one unit high:
+	// (missing characters are drawn as tofu)
+	// appends to 'lines' and returns the total advance.
+	// ('lines' is per-frame scratch -- see FrameArena.hpp -- so only lay out text from the main thread)
+	float layout(std::string_view text, frame_vector< glm::vec2 > *lines) const;
+
+	//computed in constructor (handy for lookups by name; draw_text uses match() instead):
 	std::map< std::string, uint32_t > glyph_map;
 
 	//the default font:
@@ -3,13 +3,14 @@
 #include "GL.hpp"
 #include "LitColorTextureProgram.hpp"
 #include "ColorTextureProgram.hpp"
-#include "glm/gtx/string_cast.hpp"
 
 #include "DrawLines.hpp"
 #include "Mesh.hpp"
 #include "Load.hpp"
 #include "gl_errors.hpp"
 #include "data_path.hpp"
+#include "AssetCache.hpp"
+#include "StaticBatch.hpp"
 
 #include <cmath>
 #include <glm/gtc/type_ptr.hpp>
@@ -18,106 +19,157 @@
 
 GLuint meshes_for_lit_color_texture_program = 0;
 GLuint meshes_for_unlit_color_texture_program = 0;
-Load< MeshBuffer > hexapod_meshes(LoadTagDefault, []() -> MeshBuffer const * {
-	MeshBuffer const *ret = new MeshBuffer(data_path("sub.pnct"));
-	meshes_for_lit_color_texture_program = ret->make_vao_for_program(lit_color_texture_program->program);
-	meshes_for_unlit_color_texture_program = ret->make_vao_for_program(color_texture_program->program);
-	return ret;
-});
+//(meshes and scene are shared through AssetCache, so a reload that brings back earlier file contents reuses the earlier load)
+Load< MeshBuffer > hexapod_meshes(LoadTagDefault, []() -> MeshBuffer * {
+	//(the cache hands out const assets; upload() is the only change made, and it only happens once per buffer)
+	return const_cast< MeshBuffer * >(AssetCache::load< MeshBuffer >(data_path("sub.pnct"), [](std::string const &path) -> MeshBuffer const * {
+		return new MeshBuffer(path, MeshBuffer::UploadLater);
+	}));
+}, [](MeshBuffer &ret) {
+	ret.upload();
+	meshes_for_lit_color_texture_program = ret.make_vao_for_program(lit_color_texture_program->program);
+	meshes_for_unlit_color_texture_program = ret.make_vao_for_program(color_texture_program->program);
+}, "sub.pnct");
 
 Load< Scene > hexapod_scene(LoadTagDefault, []() -> Scene const * {
-	return new Scene(data_path("sub.scene"), [&](Scene &scene, Scene::Transform *transform, std::string const &mesh_name){
-		Mesh const &mesh = hexapod_meshes->lookup(mesh_name);
-
-		scene.drawables.emplace_back(transform);
-		Scene::Drawable &drawable = scene.drawables.back();
-
-		if(transform->name == "SonarParent"
-				|| transform->name == "SonarArm"){
-			drawable.pipeline = color_texture_program_pipeline;
-			drawable.pipeline.vao = meshes_for_unlit_color_texture_program;
-		}else{
-			drawable.pipeline = lit_color_texture_program_pipeline;
-			drawable.pipeline.vao = meshes_for_lit_color_texture_program;
-		}
+	//(drawables refer to hexapod_meshes, so the scene is keyed by which mesh buffer it was built against, too)
+	return AssetCache::load< Scene >(data_path("sub.scene"), [](std::string const &path) -> Scene const * {
+		return new Scene(path, [](Scene &scene, Scene::Transform *transform, std::string const &mesh_name){
+			Mesh const &mesh = hexapod_meshes->lookup(mesh_name);
+
+			scene.drawables.emplace_back(transform);
+			Scene::Drawable &drawable = scene.drawables.back();
+
+			static Scene::Name const SonarParent("SonarParent"), SonarArm("SonarArm");
+			if(transform->name == SonarParent
+					|| transform->name == SonarArm){
+				drawable.pipeline = color_texture_program_pipeline;
+				drawable.pipeline.vao = meshes_for_unlit_color_texture_program;
+			}else{
+				drawable.pipeline = lit_color_texture_program_pipeline;
+				drawable.pipeline.vao = meshes_for_lit_color_texture_program;
+			}
 
-		drawable.pipeline.type = mesh.type;
-		drawable.pipeline.start = mesh.start;
-		drawable.pipeline.count = mesh.count;
+			drawable.pipeline.type = mesh.type;
+			drawable.pipeline.start = mesh.start;
+			drawable.pipeline.count = mesh.count;
+			drawable.lods = hexapod_meshes->lods_of(mesh);
+			drawable.lod_count = mesh.lod_count;
+			drawable.bounds_center = 0.5f * (mesh.min + mesh.max);
+			drawable.bounds_radius = 0.5f * glm::length(mesh.max - mesh.min);
 
-	});
+		});
+	}, uint64_t(reinterpret_cast< uintptr_t >(hexapod_meshes.value)));
 });
 
-Load< Sound::Sample > success(LoadTagDefault, []() -> Sound::Sample const * {
-	return new Sound::Sample(data_path("success.opus"));
+//(sounds that aren't needed right away are loaded lazily; see prefetch() calls in PlayMode::PlayMode)
+Load< Sound::Sample > success(LoadTagLazy, LoadOnWorker, []() -> Sound::Sample const * {
+	return AssetCache::load< Sound::Sample >(data_path("success.opus"));
+}, "success.opus");
+
+Load< Sound::Sample > ambient(LoadTagDefault, LoadOnWorker, []() -> Sound::Sample const * {
+	return AssetCache::load< Sound::Sample >(data_path("ambient.opus"));
+}, "ambient.opus");
+
+Load< Sound::Sample > sonar_1(LoadTagLazy, LoadOnWorker, []() -> Sound::Sample const * {
+	return AssetCache::load< Sound::Sample >(data_path("sonar1.opus"));
+}, "sonar1.opus");
+
+Load< Sound::Sample > sonar_2(LoadTagLazy, LoadOnWorker, []() -> Sound::Sample const * {
+	return AssetCache::load< Sound::Sample >(data_path("sonar2.opus"));
+}, "sonar2.opus");
+
+//hot-reload assets when they are re-exported:
+// (this works with dist/assets.bundle mounted, too: a file that changes is read from disk instead of the bundle from then on)
+// (the scene is registered after the meshes so that it picks up the new mesh data; PlayMode restarts when the scene changes)
+Load< void > watch_assets(LoadTagLate, [](){
+	hexapod_meshes.reload_on_change(data_path("sub.pnct"));
+	hexapod_scene.reload_on_change(data_path("sub.pnct"));
+	hexapod_scene.reload_on_change(data_path("sub.scene"));
+	success.reload_on_change(data_path("success.opus"));
+	ambient.reload_on_change(data_path("ambient.opus"));
+	sonar_1.reload_on_change(data_path("sonar1.opus"));
+	sonar_2.reload_on_change(data_path("sonar2.opus"));
 });
 
-Load< Sound::Sample > ambient(LoadTagDefault, []() -> Sound::Sample const * {
-	return new Sound::Sample(data_path("ambient.opus"));
-});
+//the level, with everything that update() doesn't move baked into the scene's (shared) static part:
+struct PlayMode::Level {
+	Scene const *loaded_from = nullptr; //(to notice hot-reloads)
+	Scene scene;
+	std::unique_ptr< StaticBatch > static_batch; //merged static geometry (drawn by copies of 'scene')
+};
+
+//(held weakly, so a restarting PlayMode reuses its predecessor's level, but the level's GL objects go with the last PlayMode)
+static std::shared_ptr< PlayMode::Level const > get_level() {
+	static std::weak_ptr< PlayMode::Level const > cached;
+	if (auto level = cached.lock()) {
+		if (level->loaded_from == hexapod_scene.value) return level;
+	}
 
-Load< Sound::Sample > sonar_1(LoadTagDefault, []() -> Sound::Sample const * {
-	return new Sound::Sample(data_path("sonar1.opus"));
-});
+	auto level = std::make_shared< PlayMode::Level >();
+	level->loaded_from = hexapod_scene.value;
+	level->scene.set(*hexapod_scene);
 
-Load< Sound::Sample > sonar_2(LoadTagDefault, []() -> Sound::Sample const * {
-	return new Sound::Sample(data_path("sonar2.opus"));
-});
+	//everything that update() moves (the rest of the level -- e.g., the floor -- is static, so its matrices are baked):
+	static Scene::Name const AllParent("AllParent"), SubParent("SubParent"), CamParent("CamParent"),
+		SonarArm("SonarArm"), Prop("Prop"), Sub("Sub");
+	std::vector< Scene::Transform const * > moving;
+	for (Scene::Name const &name : { AllParent, SubParent, CamParent, SonarArm, Prop, Sub }) {
+		if (Scene::Transform const *transform = level->scene.find_transform(name)) moving.emplace_back(transform);
+	}
+	level->scene.partition(moving);
 
-PlayMode::PlayMode() : scene(*hexapod_scene) {
-	//get pointers to leg for convenience:
-	for (auto &transform : scene.transforms) {
-		if (transform.name == "AllParent") allparent = &transform;
-		if (transform.name == "SubParent") subparent = &transform;
-		if (transform.name == "Prop") prop = &transform;
-		if (transform.name == "CamParent") camparent = &transform;
-		if (transform.name == "Sub") sub = &transform;
-		if (transform.name == "Sub2") sub2 = &transform;
-		if (transform.name == "Floor") floor = &transform;
-		if (transform.name == "SonarArm") sonararm = &transform;
+	//...and draw the static part in as few calls as possible:
+	level->static_batch = std::make_unique< StaticBatch >(&level->scene, std::vector< StaticBatch::Source >{
+		{ &*hexapod_meshes, meshes_for_lit_color_texture_program },
+		{ &*hexapod_meshes, meshes_for_unlit_color_texture_program },
+	});
+
+	cached = level;
+	return level;
+}
+
+PlayMode::PlayMode(uint32_t seed_, uint32_t bubble_count, ParticleBackend bubble_backend_, uint32_t lamp_count_) : seed(seed_), lamp_count(lamp_count_), rng(seed_), level(get_level()), scene(level->scene),
+	bubble_backend(bubble_backend_), bubbles(bubble_backend == ParticleBackend::CPU ? bubble_count : 0, seed_) {
+	if (bubble_backend == ParticleBackend::GPU) {
+		gpu_bubbles = std::make_unique< GPUParticles >(bubble_count, seed);
 	}
+
+	//get pointers to leg for convenience:
+	static Scene::Name const AllParent("AllParent"), SubParent("SubParent"), Prop("Prop"), CamParent("CamParent"),
+		Sub("Sub"), Sub2("Sub2"), Floor("Floor"), SonarArm("SonarArm");
+	scene.find_transforms({
+		{AllParent, &allparent},
+		{SubParent, &subparent},
+		{Prop, &prop},
+		{CamParent, &camparent},
+		{Sub, &sub},
+		{Sub2, &sub2},
+		{Floor, &floor},
+		{SonarArm, &sonararm},
+	});
 	if (sub == nullptr) throw std::runtime_error("sub not found.");
 	if (subparent == nullptr) throw std::runtime_error("subparent not found.");
 	if (floor == nullptr) throw std::runtime_error("floor not found.");
 	if (sonararm == nullptr) throw std::runtime_error("sonararm not found.");
 
-	for(int i = 0; i < particles.size(); i++){
-		Scene::Transform *transform = new Scene::Transform();
-
-		Particle *particle = new Particle();
-		particle->transform = transform;
-		particle->t = 0;
-
-		Mesh const &mesh = hexapod_meshes->lookup("Particle");
-
-		scene.drawables.emplace_back(transform);
-		Scene::Drawable &drawable = scene.drawables.back();
-
-		drawable.pipeline = lit_color_texture_program_pipeline;
-		drawable.pipeline.vao = meshes_for_lit_color_texture_program;
-
-		drawable.pipeline.type = mesh.type;
-		drawable.pipeline.start = mesh.start;
-		drawable.pipeline.count = mesh.count;
-		particles[i] = particle;
-	}
-
-	for(int i = 0; i < goals.size(); i++){
-		float x = static_cast <float> (rand()) / static_cast <float> (RAND_MAX);
-		float y = static_cast <float> (rand()) / static_cast <float> (RAND_MAX);
+	//goals and mines are entities, placed randomly:
+	auto spawn = [&](std::string const &mesh_name) -> Goal {
+		float x = random_float();
+		float y = random_float();
 
 		glm::vec3 offset = glm::vec3(x - 0.5f,y - 0.5f,1.0f) * 200.0f;
 		offset.z = 15.0f;
-		Scene::Transform *transform = new Scene::Transform();
 
-		Goal *goal = new Goal();
-		goal->transform = transform;
-		goal->transform->position = offset;
+		Goal goal;
+		goal.entity = scene.entities.spawn();
+		Scene::Entity &entity = scene.entities[goal.entity];
+		goal.transform = &entity.transform;
+		goal.transform->position = offset;
 
-		Mesh const &mesh = hexapod_meshes->lookup("Target");
+		Mesh const &mesh = hexapod_meshes->lookup(mesh_name);
 
-		scene.drawables.emplace_back(transform);
-		Scene::Drawable &drawable = scene.drawables.back();
+		Scene::Drawable &drawable = entity.drawable;
 
 		drawable.pipeline = lit_color_texture_program_pipeline;
 		drawable.pipeline.vao = meshes_for_lit_color_texture_program;
@@ -125,37 +177,60 @@ PlayMode::PlayMode() : scene(*hexapod_scene) {
 		drawable.pipeline.type = mesh.type;
 		drawable.pipeline.start = mesh.start;
 		drawable.pipeline.count = mesh.count;
-		goals[i] = goal;
+		drawable.lods = hexapod_meshes->lods_of(mesh);
+		drawable.lod_count = mesh.lod_count;
+		drawable.bounds_center = 0.5f * (mesh.min + mesh.max);
+		drawable.bounds_radius = 0.5f * glm::length(mesh.max - mesh.min);
+		return goal;
+	};
+	for (auto &goal : goals) {
+		goal = spawn("Target");
+		goal.isGoal = true;
+	}
+	for (auto &mine : mines) {
+		mine = spawn("Mine");
+		mine.isGoal = false;
 	}
 
-	for(int i = 0; i < mines.size(); i++){
-		float x = static_cast <float> (rand()) / static_cast <float> (RAND_MAX);
-		float y = static_cast <float> (rand()) / static_cast <float> (RAND_MAX);
-
-		glm::vec3 offset = glm::vec3(x - 0.5f,y - 0.5f,1.0f) * 200.0f;
-		offset.z = 15.0f;
-		Scene::Transform *transform = new Scene::Transform();
-
-		Goal *goal = new Goal();
-		goal->transform = transform;
-		goal->transform->position = offset;
-
-		Mesh const &mesh = hexapod_meshes->lookup("Mine");
-
-		scene.drawables.emplace_back(transform);
-		Scene::Drawable &drawable = scene.drawables.back();
-
-		drawable.pipeline = lit_color_texture_program_pipeline;
-		drawable.pipeline.vao = meshes_for_lit_color_texture_program;
-
-		drawable.pipeline.type = mesh.type;
-		drawable.pipeline.start = mesh.start;
-		drawable.pipeline.count = mesh.count;
-		mines[i] = goal;
+	//lights:
+	if (scene.lights.empty()) {
+		//(the level doesn't have any, so use a dim hemisphere light, shining down and forward)
+		scene.transforms.emplace_back();
+		Scene::Transform &transform = scene.transforms.back();
+		transform.rotation = glm::quat(glm::vec3(0.0f, 0.0f,-1.0f), glm::normalize(glm::vec3(0.0f, 1.0f,-1.0f)));
+		scene.lights.emplace_back(&transform);
+		scene.lights.back().type = Scene::Light::Hemisphere;
+		scene.lights.back().energy = glm::vec3(0.1f);
+	}
+	if (lamp_count > 0) {
+		//(light from the surface, slanting down, so the lamps' scene has cascaded shadows)
+		scene.transforms.emplace_back();
+		Scene::Transform &transform = scene.transforms.back();
+		transform.rotation = glm::quat(glm::vec3(0.0f, 0.0f,-1.0f), glm::normalize(glm::vec3(0.3f, 0.2f,-1.0f)));
+		scene.lights.emplace_back(&transform);
+		scene.lights.back().type = Scene::Light::Directional;
+		scene.lights.back().energy = glm::vec3(0.3f);
+	}
+	for (uint32_t i = 0; i < lamp_count; ++i) {
+		scene.transforms.emplace_back();
+		Scene::Transform &transform = scene.transforms.back();
+		float x = random_float();
+		float y = random_float();
+		transform.position = glm::vec3((x - 0.5f) * 200.0f, (y - 0.5f) * 200.0f, 2.0f + 18.0f * random_float());
+		scene.lights.emplace_back(&transform);
+		scene.lights.back().energy = 2.0f * glm::vec3(random_float(), random_float(), random_float());
+		if (i % 4 == 3) {
+			//(pointing straight down)
+			scene.lights.back().type = Scene::Light::Spot;
+			scene.lights.back().spot_fov = glm::radians(60.0f);
+		} else {
+			scene.lights.back().type = Scene::Light::Point;
+		}
 	}
 
 	amountCollected = 0;
 	total = (int)goals.size();
+	update_goals_text();
 
 	subRotation = sub->rotation;
 
@@ -163,10 +238,39 @@ PlayMode::PlayMode() : scene(*hexapod_scene) {
 	if (scene.cameras.size() != 1) throw std::runtime_error("Expecting scene to have exactly one camera, but it has " + std::to_string(scene.cameras.size()));
 	camera = &scene.cameras.front();
 
+	//simulate at a fixed rate, so movement doesn't depend on frame rate:
+	fixed_timestep = 1.0f / 60.0f;
+	threaded_update_ok = true;
+	mouse_captured = (SDL_GetRelativeMouseMode() == SDL_TRUE); //(keep the capture state across hot-reload restarts)
+
+	//lit_color_texture_program's fog is opaque past sqrt(2000) units, so detail isn't needed there:
+	scene.lod_fog_distance = std::sqrt(2000.0f);
+
+	//make the copy of the scene that draw() uses:
+	// (copies keep transform order and entity slots, so transforms can be paired up by walking both scenes)
+	// (both scenes share the level's static part, so this copies only the dynamic transforms -- and only they need interpolating)
+	draw_scene.set(scene);
+
+	auto draw_transform = draw_scene.transforms.begin();
+	for (auto &transform : scene.transforms) {
+		interpolator.transforms.emplace_back(&transform);
+		draw_transforms.emplace_back(&*draw_transform);
+		++draw_transform;
+	}
+	for (uint32_t i = 0; i < scene.entities.slots; ++i) {
+		interpolator.transforms.emplace_back(&scene.entities[i].transform);
+		draw_transforms.emplace_back(&draw_scene.entities[i].transform);
+	}
+	draw_camera = &draw_scene.cameras.front();
+
 	//start music loop playing:
 	// (note: position will be over-ridden in update())
 	//leg_tip_loop = Sound::loop_3D(*dusty_floor_sample, 1.0f, glm::vec3(0), 10.0f);
 	Sound::loop(*ambient, 1.0f, 10.0f);
+
+	//decode sounds that will be needed once play starts in the background:
+	sonar_1.prefetch();
+	success.prefetch();
 }
 
 PlayMode::~PlayMode() {
@@ -176,7 +280,7 @@ bool PlayMode::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size)
 
 	if (evt.type == SDL_KEYDOWN) {
 		if (evt.key.keysym.sym == SDLK_ESCAPE) {
-			SDL_SetRelativeMouseMode(SDL_FALSE);
+			mouse_captured = false;
 			return true;
 		} else if (evt.key.keysym.sym == SDLK_a) {
 			left.downs += 1;
@@ -224,12 +328,12 @@ bool PlayMode::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size)
 			return true;
 		}
 	} else if (evt.type == SDL_MOUSEBUTTONDOWN) {
-		if (SDL_GetRelativeMouseMode() == SDL_FALSE) {
-			SDL_SetRelativeMouseMode(SDL_TRUE);
+		if (!mouse_captured) {
+			mouse_captured = true;
 			return true;
 		}
 	} else if (evt.type == SDL_MOUSEMOTION) {
-		if (SDL_GetRelativeMouseMode() == SDL_TRUE) {
+		if (mouse_captured) {
 			return true;
 		}
 	}
@@ -238,32 +342,11 @@ bool PlayMode::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size)
 }
 
 void PlayMode::update(float elapsed) {
-	//Process particles
-	for(int i = 0; i < particles.size(); i++){
-		if(particles[i]->t == 0){
-			float x = static_cast <float> (rand()) / static_cast <float> (RAND_MAX);
-			float y = static_cast <float> (rand()) / static_cast <float> (RAND_MAX);
-			float z = static_cast <float> (rand()) / static_cast <float> (RAND_MAX);
-
-			glm::vec3 offset = glm::vec3(x - 0.5f,y - 0.5f,z - 0.5f) * 15.0f;
-			particles[i]->transform->position = allparent->position + offset;
-			particles[i]->maxT = 3.0f * static_cast <float> (rand()) / static_cast <float> (RAND_MAX);
-			particles[i]->transform->scale = glm::vec3(0);
-		}
-		particles[i]->t += elapsed;
-		particles[i]->transform->position += glm::vec3(0, 0, 3.0f) * elapsed;
-
-		if(particles[i]->t < particles[i]->maxT / 2.0f){
-			particles[i]->transform->scale = glm::mix(glm::vec3(0), glm::vec3(0.1f), particles[i]->t);
-		}else{
-			particles[i]->transform->scale = glm::mix(glm::vec3(0.1f), glm::vec3(0), (particles[i]->t) - (particles[i]->maxT /2.0f));
-		}
-
+	interpolator.begin_step();
 
-		if(particles[i]->t >= particles[i]->maxT){
-			particles[i]->t = 0;
-		}
-	}
+	//bubbles spawn around wherever the sub is:
+	bubble_emitter.center = allparent->position;
+	bubbles.update(elapsed, bubble_emitter); //(gpu_bubbles catch up in draw())
 
 	{
 
@@ -314,19 +397,19 @@ void PlayMode::update(float elapsed) {
 		}
 
 		for(int i = 0; i < goals.size(); i++){
-			if(!goals[i]->isCollected){
-				goals[i]->transform->rotation = glm::normalize(
-						goals[i]->transform->rotation
+			if(!goals[i].isCollected){
+				goals[i].transform->rotation = glm::normalize(
+						goals[i].transform->rotation
 						* glm::angleAxis(2.0f * elapsed, glm::vec3(0, 0, 1.0f))
 						);
-				if(DidPassLocation(currentSonarAngle, newSonarAngle, goals[i]->transform->position)){
-					Sound::play(*sonar_1, 1.0f, 0.0f);
+				if(DidPassLocation(currentSonarAngle, newSonarAngle, goals[i].transform->position)){
+					sonar_pings += 1;
 				}
-				if(glm::length(goals[i]->transform->position - allparent->position) < 5.0f){
-					Sound::play(*success, 1.0f, 0.0f);
+				if(glm::length(goals[i].transform->position - allparent->position) < 5.0f){
+					successes += 1;
 					amountCollected++;
-					goals[i]->transform->position = glm::vec3(0, 0, -20);
-					goals[i]->isCollected = true;
+					goals[i].transform->position = glm::vec3(0, 0, -20);
+					goals[i].isCollected = true;
 				}
 			}
 		}
@@ -368,13 +451,28 @@ void PlayMode::update(float elapsed) {
 	right.downs = 0;
 	forward.downs = 0;
 	back.downs = 0;
+
+	interpolator.end_step();
+
+	//hand this step's results over to draw():
+	Snapshot &snapshot = snapshots.write_buffer();
+	snapshot.previous = interpolator.previous;
+	snapshot.current = interpolator.current;
+	snapshot.amount_collected = amountCollected;
+	bubbles.pack(&snapshot.bubbles);
+	snapshot.bubble_emitter = bubble_emitter;
+	simulated_time += elapsed;
+	snapshot.time = simulated_time;
+	snapshots.publish();
+}
+
+void PlayMode::interpolate(float alpha) {
+	draw_alpha = alpha;
 }
 
 bool PlayMode::DidPassLocation(float prevAngle, float newAngle, glm::vec3 location){
 	glm::vec3 localLocation = sub->make_world_to_local() * glm::vec4(location, 1.0f);
 	float angle = (std::atan2(localLocation.y, localLocation.x) + glm::pi<float>());
-	printf("local location: %s\n", glm::to_string(localLocation).c_str());
-	printf("%f\n", angle);
 
 	bool currentSign = std::signbit(angle - currentSonarAngle);
 	bool newSign = std::signbit(angle - newAngle);
@@ -388,18 +486,59 @@ bool PlayMode::DidPassLocation(float prevAngle, float newAngle, glm::vec3 locati
 	return false;
 }
 
+float PlayMode::random_float() {
+	//(not std::uniform_real_distribution, which may give different numbers with different standard libraries)
+	return float(rng() >> 8) * (1.0f / float(1 << 24));
+}
+
+void PlayMode::update_goals_text() {
+	goals_text.set(std::to_string(shown_collected) + "/" + std::to_string(total) + " goals collected.");
+}
+
 void PlayMode::draw(glm::uvec2 const &drawable_size) {
+	//scene was hot-reloaded (see 'watch_assets', above), so start over with the new one:
+	// (done here rather than in update() because update() may be running on another thread)
+	if (hexapod_scene.value != level->loaded_from) {
+		auto self = shared_from_this(); //(keep this mode alive until draw returns)
+		uint32_t bubble_count = (gpu_bubbles ? gpu_bubbles->count : bubbles.count);
+		Mode::set_current(std::make_shared< PlayMode >(seed, bubble_count, bubble_backend, lamp_count));
+		Mode::current->draw(drawable_size);
+		return;
+	}
+
+	//catch up with the simulation:
+	snapshots.update();
+	Snapshot const &snapshot = snapshots.read_buffer();
+	Scene::blend_transforms(snapshot.previous, snapshot.current, draw_alpha, draw_transforms);
+	if (snapshot.amount_collected != shown_collected) {
+		shown_collected = snapshot.amount_collected;
+		update_goals_text();
+	}
+	for (uint32_t n = sonar_pings.exchange(0); n > 0; --n) {
+		Sound::play(*sonar_1, 1.0f, 0.0f);
+	}
+	for (uint32_t n = successes.exchange(0); n > 0; --n) {
+		Sound::play(*success, 1.0f, 0.0f);
+	}
+	SDL_bool relative = (mouse_captured ? SDL_TRUE : SDL_FALSE);
+	if (SDL_GetRelativeMouseMode() != relative) {
+		SDL_SetRelativeMouseMode(relative);
+	}
+
 	//update camera aspect ratio for drawable:
-	camera->aspect = float(drawable_size.x) / float(drawable_size.y);
+	draw_camera->aspect = float(drawable_size.x) / float(drawable_size.y);
 
 	glm::vec4 fog_color(0.173f, 0.635f, 0.792f, 1.0f);
 
-	//set up light type and position for lit_color_texture_program:
-	// TODO: consider using the Light(s) in the scene to do this
+	//bring shadow maps up to date (usually by reusing last frame's) and set up lit_color_texture_program's
+	// lights from the scene's (lights and shadows past the fog can't be seen):
+	shadow_maps.far = draw_scene.lod_fog_distance;
+	shadow_maps.update(draw_scene, *draw_camera);
+	shadow_maps.bind();
+	light_clusters.far = draw_scene.lod_fog_distance;
+	light_clusters.update(draw_scene.lights, *draw_camera, drawable_size, &shadow_maps);
+	light_clusters.bind();
 	glUseProgram(lit_color_texture_program->program);
-	glUniform1i(lit_color_texture_program->LIGHT_TYPE_int, 1);
-	glUniform3fv(lit_color_texture_program->LIGHT_DIRECTION_vec3, 1, glm::value_ptr(glm::vec3(0.0f, 1.0f,-1.0f)));
-	glUniform3fv(lit_color_texture_program->LIGHT_ENERGY_vec3, 1, glm::value_ptr(glm::vec3(1.0f, 1.0f, 1.0f) * 0.1f));
 	glUniform4fv(lit_color_texture_program->FOG_COLOR_vec4, 1, glm::value_ptr(fog_color));
 	glUseProgram(0);
 
@@ -410,28 +549,39 @@ void PlayMode::draw(glm::uvec2 const &drawable_size) {
 	glEnable(GL_DEPTH_TEST);
 	glDepthFunc(GL_LESS); //this is the default depth comparison function, but FYI you can change it.
 
-	scene.draw(*camera);
+	draw_scene.draw(*draw_camera);
+	light_clusters.unbind();
+	shadow_maps.unbind();
 
-	{ //use DrawLines to overlay some text:
+	bubble_renderer.fog_color = fog_color;
+	if (gpu_bubbles) {
+		//advance the GPU's bubbles to the simulation's time (in one step, however many updates ran):
+		if (snapshot.time > gpu_bubbles_time) {
+			gpu_bubbles->update(float(snapshot.time - gpu_bubbles_time), snapshot.bubble_emitter);
+			gpu_bubbles_time = snapshot.time;
+		}
+		gpu_bubbles->draw(bubble_renderer, *draw_camera);
+	} else {
+		bubble_renderer.draw(snapshot.bubbles.data(), uint32_t(snapshot.bubbles.size()), *draw_camera);
+	}
+
+	{ //overlay goal count (drawn twice: a shadow, then the text itself):
 		glDisable(GL_DEPTH_TEST);
 		float aspect = float(drawable_size.x) / float(drawable_size.y);
-		DrawLines lines(glm::mat4(
-			1.0f / aspect, 0.0f, 0.0f, 0.0f,
-			0.0f, 1.0f, 0.0f, 0.0f,
-			0.0f, 0.0f, 1.0f, 0.0f,
-			0.0f, 0.0f, 0.0f, 1.0f
-		));
 
 		constexpr float H = 0.09f;
-		lines.draw_text(std::to_string(amountCollected) + "/" + std::to_string(total) + " goals collected.",
-			glm::vec3(-aspect + 0.1f * H, -1.0 + 0.1f * H, 0.0),
-			glm::vec3(H, 0.0f, 0.0f), glm::vec3(0.0f, H, 0.0f),
-			glm::u8vec4(0x00, 0x00, 0x00, 0x00));
+		auto text_to_clip = [&](glm::vec2 const &at) {
+			return glm::mat4(
+				H / aspect, 0.0f, 0.0f, 0.0f,
+				0.0f, H, 0.0f, 0.0f,
+				0.0f, 0.0f, 1.0f, 0.0f,
+				at.x / aspect, at.y, 0.0f, 1.0f
+			);
+		};
+		glm::vec2 at(-aspect + 0.1f * H, -1.0f + 0.1f * H);
 		float ofs = 2.0f / drawable_size.y;
-		lines.draw_text(std::to_string(amountCollected) + "/" + std::to_string(total) + " goals collected.",
-			glm::vec3(-aspect + 0.1f * H + ofs, -1.0 + + 0.1f * H + ofs, 0.0),
-			glm::vec3(H, 0.0f, 0.0f), glm::vec3(0.0f, H, 0.0f),
-			glm::u8vec4(0xff, 0xff, 0xff, 0x00));
+		goals_text.draw(text_to_clip(at), glm::vec4(0.0f, 0.0f, 0.0f, 0.0f));
+		goals_text.draw(text_to_clip(at + glm::vec2(ofs)), glm::vec4(1.0f, 1.0f, 1.0f, 0.0f));
 	}
 	GL_ERRORS();
 }
@@ -1,35 +1,56 @@
 #include "Mode.hpp"
 
 #include "Scene.hpp"
+#include "LightClusters.hpp"
+#include "ShadowMaps.hpp"
 #include "Sound.hpp"
 #include "Particle.hpp"
 #include "Goal.hpp"
+#include "TextMesh.hpp"
+#include "TripleBuffer.hpp"
 
 #include <glm/glm.hpp>
 
 #include <vector>
 #include <deque>
 #include <array>
+#include <random>
+#include <atomic>
+#include <memory>
 
 struct PlayMode : Mode {
-	PlayMode();
+	//'seed' determines goal, mine, and lamp placement and particle motion (so sessions can be replayed):
+	// ('lamp_count' scatters that many colored lamps -- point lights, and every fourth a shadowed spot light -- around the level, under a shadowed directional light)
+	PlayMode(uint32_t seed, uint32_t bubble_count = DefaultBubbles, ParticleBackend bubble_backend = ParticleBackend::CPU, uint32_t lamp_count = 0);
 	virtual ~PlayMode();
 
 	//functions called by main loop:
 	virtual bool handle_event(SDL_Event const &, glm::uvec2 const &window_size) override;
 	virtual void update(float elapsed) override;
+	virtual void interpolate(float alpha) override;
 	virtual void draw(glm::uvec2 const &drawable_size) override;
 	bool DidPassLocation(float prevAngle, float newAngle, glm::vec3 position);
 
 	//----- game state -----
 
+	//all randomness comes from here, so the same seed (and input) gives the same session:
+	uint32_t seed;
+	uint32_t lamp_count; //(kept so a reloaded scene gets the same lamps)
+	std::mt19937 rng;
+	float random_float(); //in [0,1)
+
 	//input tracking:
 	struct Button {
 		uint8_t downs = 0;
 		uint8_t pressed = 0;
 	} left, right, back, forward, up, down;
 
-	//local copy of the game scene (so code can change it during gameplay):
+	//the game scene, partitioned and batched once per loaded scene (and shared by PlayModes made while it's alive):
+	struct Level;
+	std::shared_ptr< Level const > level;
+
+	//local copy of the level (so code can change it during gameplay):
+	// (it shares the level's static part, so making one only copies the level's moving parts)
 	Scene scene;
 
 	//hexapod leg to wobble:
@@ -42,17 +63,58 @@ struct PlayMode : Mode {
 	Scene::Transform *camparent = nullptr;
 	Scene::Transform *floor = nullptr;
 	Scene::Transform *sonararm = nullptr;
-	std::array<Particle*, 25> particles;
-	std::array<Goal*, 10> goals;
-	std::array<Goal*, 10> mines;
+	std::array<Goal, 10> goals; //(transforms and drawables are in scene.entities)
+	std::array<Goal, 10> mines;
 	float currentSonarAngle = 0.0f;
 	int amountCollected;
 	int total;
 
+	//"N/M goals collected." (only re-built when the count changes):
+	TextMesh goals_text;
+	int shown_collected = 0; //count currently in goals_text
+	void update_goals_text();
+
+	//bubbles that rise around the sub:
+	// (simulated in update() by 'bubbles', or -- with ParticleBackend::GPU -- in draw() by 'gpu_bubbles')
+	static constexpr uint32_t DefaultBubbles = 250;
+	ParticleBackend bubble_backend;
+	Particles bubbles; //(empty with the GPU backend)
+	std::unique_ptr< GPUParticles > gpu_bubbles; //(only with the GPU backend)
+	double gpu_bubbles_time = 0.0; //simulation time gpu_bubbles have been advanced to
+	ParticleEmitter bubble_emitter;
+	ParticleRenderer bubble_renderer;
+
 	//music coming from the tip of the leg (as a demonstration):
 	std::shared_ptr< Sound::PlayingSample > leg_tip_loop;
 	
 	//camera:
 	Scene::Camera *camera = nullptr;
 
+	//----- simulation -> drawing -----
+	//simulation runs at a fixed rate (possibly on its own thread; see Mode::threaded_update_ok),
+	// so each update() hands its results to draw() as a snapshot, which draw() blends into 'draw_scene':
+	Scene::Interpolator interpolator; //records states of all of 'scene's transforms around each step
+	struct Snapshot {
+		std::vector< Scene::TransformState > previous, current;
+		int amount_collected = 0;
+		std::vector< glm::vec4 > bubbles; //see Particles::pack
+		ParticleEmitter bubble_emitter; //(for gpu_bubbles)
+		double time = 0.0; //total time simulated
+	};
+	TripleBuffer< Snapshot > snapshots;
+	float draw_alpha = 1.0f; //from interpolate()
+	double simulated_time = 0.0; //total of update()'s elapsed times
+
+	Scene draw_scene; //copy of 'scene' that is actually drawn
+	ShadowMaps shadow_maps; //draw_scene's directional and spot lights' shadows
+	LightClusters light_clusters; //draw_scene's lights, binned for lit_color_texture_program
+	std::vector< Scene::Transform * > draw_transforms; //draw_scene's copy of each of interpolator.transforms
+	Scene::Camera *draw_camera = nullptr;
+
+	//sounds triggered by update(), played by draw() (lazily-loaded samples must be used from the main thread):
+	std::atomic< uint32_t > sonar_pings{0};
+	std::atomic< uint32_t > successes{0};
+	//...and mouse capture requested by handle_event(), applied by draw() (SDL's video functions must be called from the main thread):
+	std::atomic< bool > mouse_captured{false};
+
 };
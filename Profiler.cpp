@@ -0,0 +1,300 @@
+#include "Profiler.hpp"
+
+#include "DrawLines.hpp"
+#include "FrameArena.hpp"
+#include "GL.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+bool Profiler::show_overlay = false;
+uint64_t Profiler::draw_calls = 0;
+
+namespace {
+	using Clock = std::chrono::high_resolution_clock;
+	Clock::time_point const start_time = Clock::now();
+
+	double now_ms() {
+		return std::chrono::duration< double, std::milli >(Clock::now() - start_time).count();
+	}
+
+	struct CPUSample {
+		char const *name;
+		uint32_t depth; //number of enclosing scopes
+		double begin_ms, end_ms;
+	};
+
+	struct GPUSample {
+		char const *name;
+		GLuint query; //0 once result has been read
+		double issued_ms; //when the GL calls were issued (GPU timestamps aren't recorded, so traces use this as the start)
+		double ms; //-1 until result has been read
+	};
+
+	struct Frame {
+		uint64_t number = 0; //0 if never used
+		double begin_ms = 0.0;
+		double end_ms = 0.0; //set when the next frame begins
+		uint64_t heap_begin = 0; //FrameArena::heap_allocations() when the frame began
+		uint64_t heap_allocations = 0; //set when the next frame begins
+		uint64_t draws_begin = 0; //Profiler::draw_calls when the frame began
+		uint64_t draws = 0; //set when the next frame begins
+		std::vector< CPUSample > cpu; //(vectors are re-used, so recording doesn't allocate once warmed up)
+		std::vector< GPUSample > gpu;
+	};
+
+	std::array< Frame, Profiler::HistoryFrames > frames;
+	uint64_t frame_number = 0; //number of the current frame; frames are numbered from 1
+	uint32_t depth = 0; //currently open CPU scopes
+	bool gpu_scope_open = false;
+	std::vector< GLuint > free_queries;
+
+	Frame &get_frame(uint64_t number) {
+		return frames[number % Profiler::HistoryFrames];
+	}
+
+	//printf into a per-frame string (overlay text is rebuilt every frame, so it shouldn't touch the heap):
+	frame_string frame_printf(char const *format, ...) {
+		char buffer[256];
+		va_list args;
+		va_start(args, format);
+		int length = std::vsnprintf(buffer, sizeof(buffer), format, args);
+		va_end(args);
+		if (length < 0) return frame_string();
+		return frame_string(buffer, std::min(size_t(length), sizeof(buffer) - 1));
+	}
+
+	//read back finished GL_TIME_ELAPSED queries (waiting for them if 'wait' is set):
+	void resolve(Frame &frame, bool wait) {
+		for (auto &sample : frame.gpu) {
+			if (sample.query == 0) continue;
+			GLuint available = GL_FALSE;
+			if (!wait) glGetQueryObjectuiv(sample.query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (wait || available) {
+				GLuint64 ns = 0;
+				glGetQueryObjectui64v(sample.query, GL_QUERY_RESULT, &ns);
+				sample.ms = double(ns) / 1.0e6;
+				free_queries.emplace_back(sample.query);
+				sample.query = 0;
+			}
+		}
+	}
+
+	//frames that are finished (i.e., not the current frame), oldest first:
+	void for_each_finished_frame(std::function< void(Frame const &) > const &fn) {
+		for (uint64_t age = Profiler::HistoryFrames - 1; age >= 1; --age) {
+			if (age >= frame_number) continue;
+			fn(get_frame(frame_number - age));
+		}
+	}
+}
+
+void Profiler::new_frame() {
+	double now = now_ms();
+	uint64_t heap = FrameArena::heap_allocations();
+	if (frame_number > 0) {
+		get_frame(frame_number).end_ms = now;
+		get_frame(frame_number).heap_allocations = heap - get_frame(frame_number).heap_begin;
+		get_frame(frame_number).draws = draw_calls - get_frame(frame_number).draws_begin;
+	}
+
+	//pick up GPU timings from the last few frames, if they are ready:
+	for (uint64_t age = 0; age < 4 && age < frame_number; ++age) {
+		resolve(get_frame(frame_number - age), false);
+	}
+
+	frame_number += 1;
+	Frame &frame = get_frame(frame_number);
+	resolve(frame, true); //(queries from HistoryFrames frames ago are long done)
+	frame.number = frame_number;
+	frame.begin_ms = now;
+	frame.end_ms = now;
+	frame.heap_begin = heap;
+	frame.heap_allocations = 0;
+	frame.draws_begin = draw_calls;
+	frame.draws = 0;
+	frame.cpu.clear();
+	frame.gpu.clear();
+	depth = 0;
+}
+
+Profiler::Scope::Scope(char const *name) : index(-1U) {
+	if (frame_number == 0) return; //(not recording yet)
+	Frame &frame = get_frame(frame_number);
+	index = uint32_t(frame.cpu.size());
+	frame.cpu.emplace_back(CPUSample{name, depth, now_ms(), 0.0});
+	depth += 1;
+}
+
+Profiler::Scope::~Scope() {
+	if (index == -1U) return;
+	depth -= 1;
+	get_frame(frame_number).cpu[index].end_ms = now_ms();
+}
+
+Profiler::GPUScope::GPUScope(char const *name) : active(false) {
+	if (frame_number == 0 || gpu_scope_open) return;
+
+	GLuint query = 0;
+	if (free_queries.empty()) {
+		glGenQueries(1, &query);
+	} else {
+		query = free_queries.back();
+		free_queries.pop_back();
+	}
+	get_frame(frame_number).gpu.emplace_back(GPUSample{name, query, now_ms(), -1.0});
+	glBeginQuery(GL_TIME_ELAPSED, query);
+
+	gpu_scope_open = true;
+	active = true;
+}
+
+Profiler::GPUScope::~GPUScope() {
+	if (!active) return;
+	glEndQuery(GL_TIME_ELAPSED);
+	gpu_scope_open = false;
+}
+
+void Profiler::write_trace(std::string const &filename) {
+	std::ofstream out(filename, std::ios::binary);
+	if (!out) {
+		std::cerr << "WARNING: failed to open '" << filename << "' to write profile trace." << std::endl;
+		return;
+	}
+
+	//times in trace files are in microseconds:
+	auto us = [](double ms) { return std::to_string(int64_t(ms * 1000.0)); };
+	//(names are string literals, but be careful anyway)
+	auto quoted = [](char const *name) {
+		std::string ret = "\"";
+		for (char const *c = name; *c != '\0'; ++c) {
+			if (*c == '"' || *c == '\\') ret += '\\';
+			ret += *c;
+		}
+		return ret + "\"";
+	};
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+	out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"GPU\"}}";
+	uint32_t written = 0;
+	for_each_finished_frame([&](Frame const &frame) {
+		if (frame.number == 0) return;
+		written += 1;
+		out << ",\n{\"name\":\"frame\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":" << us(frame.begin_ms) << ",\"dur\":" << us(frame.end_ms - frame.begin_ms)
+			<< ",\"args\":{\"frame\":" << frame.number << ",\"heap_allocations\":" << frame.heap_allocations << ",\"draw_calls\":" << frame.draws << "}}";
+		for (auto const &sample : frame.cpu) {
+			out << ",\n{\"name\":" << quoted(sample.name) << ",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":" << us(sample.begin_ms) << ",\"dur\":" << us(sample.end_ms - sample.begin_ms) << "}";
+		}
+		for (auto const &sample : frame.gpu) {
+			if (sample.ms < 0.0) continue; //(result not read back yet)
+			out << ",\n{\"name\":" << quoted(sample.name) << ",\"ph\":\"X\",\"pid\":0,\"tid\":1,\"ts\":" << us(sample.issued_ms) << ",\"dur\":" << us(sample.ms) << "}";
+		}
+	});
+	out << "\n]}\n";
+
+	std::cout << "Wrote " << written << " frames of profile data to '" << filename << "'." << std::endl;
+}
+
+void Profiler::draw_overlay(glm::uvec2 const &drawable_size) {
+	float aspect = float(drawable_size.x) / float(drawable_size.y);
+	float px = 2.0f / float(drawable_size.y); //size of a pixel
+
+	DrawLines lines(glm::mat4(
+		1.0f / aspect, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	));
+
+	//colors picked by name (so the same scope has the same color everywhere):
+	auto color_for = [](char const *name) {
+		static const std::array< glm::u8vec4, 6 > palette{
+			glm::u8vec4(0xff, 0x88, 0x44, 0xff), glm::u8vec4(0x44, 0xdd, 0x66, 0xff), glm::u8vec4(0x44, 0x99, 0xff, 0xff),
+			glm::u8vec4(0xee, 0xdd, 0x44, 0xff), glm::u8vec4(0xcc, 0x66, 0xff, 0xff), glm::u8vec4(0x44, 0xdd, 0xdd, 0xff)
+		};
+		uint32_t hash = 2166136261U;
+		for (char const *c = name; *c != '\0'; ++c) hash = (hash ^ uint8_t(*c)) * 16777619U;
+		return palette[hash % palette.size()];
+	};
+
+	//------ graph: one column per frame, stacked top-level CPU scopes; GPU total as a white tick ------
+	constexpr float MsHeight = 0.015f; //height of one millisecond
+	glm::vec2 origin(-aspect + 0.05f, 0.3f);
+
+	for (float budget : {1000.0f / 60.0f, 1000.0f / 30.0f}) {
+		lines.draw(glm::vec3(origin.x, origin.y + budget * MsHeight, 0.0f), glm::vec3(origin.x + HistoryFrames * px, origin.y + budget * MsHeight, 0.0f), glm::u8vec4(0x88, 0x88, 0x88, 0xff));
+	}
+
+	struct Average {
+		char const *name;
+		bool gpu;
+		double total_ms = 0.0;
+	};
+	frame_vector< Average > averages;
+	auto accumulate = [&averages](char const *name, bool gpu, double ms) {
+		for (auto &a : averages) {
+			if (a.gpu == gpu && std::strcmp(a.name, name) == 0) {
+				a.total_ms += ms;
+				return;
+			}
+		}
+		averages.emplace_back(Average{name, gpu, ms});
+	};
+
+	uint32_t column = 0;
+	uint32_t counted = 0;
+	double frame_total_ms = 0.0;
+	uint64_t heap_total = 0;
+	uint64_t draws_total = 0;
+	for_each_finished_frame([&](Frame const &frame) {
+		float x = origin.x + column * px;
+		column += 1;
+		if (frame.number == 0) return;
+		counted += 1;
+		frame_total_ms += frame.end_ms - frame.begin_ms;
+		heap_total += frame.heap_allocations;
+		draws_total += frame.draws;
+
+		float y = origin.y;
+		for (auto const &sample : frame.cpu) {
+			if (sample.depth != 0) continue;
+			float height = float(sample.end_ms - sample.begin_ms) * MsHeight;
+			lines.draw(glm::vec3(x, y, 0.0f), glm::vec3(x, y + height, 0.0f), color_for(sample.name));
+			y += height;
+			accumulate(sample.name, false, sample.end_ms - sample.begin_ms);
+		}
+		double gpu_ms = 0.0;
+		for (auto const &sample : frame.gpu) {
+			if (sample.ms < 0.0) continue;
+			gpu_ms += sample.ms;
+			accumulate(sample.name, true, sample.ms);
+		}
+		float gy = origin.y + float(gpu_ms) * MsHeight;
+		lines.draw(glm::vec3(x, gy, 0.0f), glm::vec3(x, gy + 2.0f * px, 0.0f), glm::u8vec4(0xff));
+	});
+
+	//------ legend: average times ------
+	constexpr float H = 0.04f;
+	glm::vec3 at(origin.x, origin.y - 1.5f * H, 0.0f);
+	auto line = [&](frame_string const &text, glm::u8vec4 const &color) {
+		lines.draw_text(text, at, glm::vec3(H, 0.0f, 0.0f), glm::vec3(0.0f, H, 0.0f), color);
+		at.y -= 1.2f * H;
+	};
+
+	if (counted == 0) return;
+	line(frame_printf("frame %.2fms (avg of %u)", frame_total_ms / counted, counted), glm::u8vec4(0xff));
+	line(frame_printf("heap allocations %llu/frame, arena %lluk", (unsigned long long)(heap_total / counted), (unsigned long long)(FrameArena::capacity() / 1024)), glm::u8vec4(0xff));
+	line(frame_printf("draw calls %llu/frame", (unsigned long long)(draws_total / counted)), glm::u8vec4(0xff));
+	for (auto const &a : averages) {
+		line(frame_printf("%s%s %.2fms", (a.gpu ? "gpu " : ""), a.name, a.total_ms / counted), a.gpu ? glm::u8vec4(0xff) : color_for(a.name));
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+/*
+ * Profiler records where each frame's time goes:
+ *
+ *  - CPU time, with PROFILE_SCOPE("name") (or a Profiler::Scope) around code;
+ *    scopes may nest.
+ *  - GPU time, with PROFILE_GPU_SCOPE("name") (or a Profiler::GPUScope) around
+ *    GL calls; these use GL_TIME_ELAPSED queries, which can't nest, and whose
+ *    results are read back a few frames later (so the CPU never waits for them).
+ *
+ * Heap allocations and draw calls per frame are counted too (see FrameArena.hpp and count_draw_call).
+ *
+ * The last HistoryFrames frames are kept in a ring buffer, which can be shown
+ * as an overlay (draw_overlay) or written out as a Chrome trace (write_trace;
+ * open in chrome://tracing or https://ui.perfetto.dev).
+ *
+ * Only use from the main (OpenGL context) thread.
+ *
+ */
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace Profiler {
+
+//Number of frames kept for the overlay and trace:
+constexpr uint32_t HistoryFrames = 240;
+
+//Start recording a new frame (call once per frame, at the top of the main loop):
+void new_frame();
+
+//Time a CPU scope (name should be a string literal -- it is stored as a pointer):
+struct Scope {
+	Scope(char const *name);
+	~Scope();
+	uint32_t index; //sample being timed
+};
+
+//Time the GL calls made in a scope (name should be a string literal):
+// (GL_TIME_ELAPSED queries can't nest, so GPUScopes can't either)
+struct GPUScope {
+	GPUScope(char const *name);
+	~GPUScope();
+	bool active; //false if another GPUScope was already open
+};
+
+//Count a draw call (call next to each glDraw*):
+extern uint64_t draw_calls; //since program start
+inline void count_draw_call() { draw_calls += 1; }
+
+//Write recorded frames to a Chrome trace ("Trace Event Format") JSON file:
+void write_trace(std::string const &filename);
+
+//Draw a graph of recent frame times and average times of each top-level scope:
+// (uses DrawLines; call after everything else is drawn)
+void draw_overlay(glm::uvec2 const &drawable_size);
+
+//Should draw_overlay be called? (toggled by main.cpp)
+extern bool show_overlay;
+
+} //namespace Profiler
+
+#define PROFILE_CONCAT2(a, b) a ## b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#define PROFILE_SCOPE(name) Profiler::Scope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#define PROFILE_GPU_SCOPE(name) Profiler::GPUScope PROFILE_CONCAT(profile_gpu_scope_, __LINE__)(name)
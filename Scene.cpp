@@ -3,10 +3,19 @@
 #include <glm/gtx/string_cast.hpp>
 #include "gl_errors.hpp"
 #include "read_write_chunk.hpp"
+#include "data_path.hpp"
+#include "Jobs.hpp"
+#include "FrameArena.hpp"
+#include "Profiler.hpp"
 
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <deque>
 #include <fstream>
+#include <mutex>
+#include <string_view>
+#include <stdexcept>
 
 //-------------------------
 
@@ -81,6 +90,415 @@ glm::mat4 Scene::Camera::make_projection() const {
 //-------------------------
 
 
+void Scene::Interpolator::begin_step() {
+	if (applied) {
+		//put back simulated states (apply() only runs when 'current' matches 'transforms'):
+		for (size_t i = 0; i < transforms.size(); ++i) {
+			transforms[i]->position = current[i].position;
+			transforms[i]->rotation = current[i].rotation;
+			transforms[i]->scale = current[i].scale;
+		}
+		applied = false;
+	}
+	previous.clear();
+	for (Transform const *t : transforms) {
+		previous.emplace_back(TransformState{t->position, t->rotation, t->scale});
+	}
+}
+
+void Scene::Interpolator::end_step() {
+	current.clear();
+	for (Transform const *t : transforms) {
+		current.emplace_back(TransformState{t->position, t->rotation, t->scale});
+	}
+}
+
+void Scene::Interpolator::apply(float alpha) {
+	//(nothing to blend until a step has run with the current set of transforms)
+	if (previous.size() != transforms.size() || current.size() != transforms.size()) return;
+	blend_transforms(previous, current, alpha, transforms);
+	applied = true;
+}
+
+void Scene::blend_transforms(std::vector< TransformState > const &a, std::vector< TransformState > const &b, float alpha, std::vector< Transform * > const &to) {
+	if (a.size() != to.size() || b.size() != to.size()) return;
+	for (size_t i = 0; i < to.size(); ++i) {
+		to[i]->position = glm::mix(a[i].position, b[i].position, alpha);
+		to[i]->rotation = glm::slerp(a[i].rotation, b[i].rotation, alpha);
+		to[i]->scale = glm::mix(a[i].scale, b[i].scale, alpha);
+	}
+}
+
+//interned names:
+namespace {
+	struct NameTable {
+		NameTable() {
+			strings.emplace_back(); //(id 0 is the empty name)
+			ids.emplace(strings.back(), 0);
+		}
+		std::mutex mutex;
+		std::deque< std::string > strings; //(deque, so that strings never move -- 'ids' keys and str() results point into them)
+		std::unordered_map< std::string_view, uint32_t > ids;
+	};
+	NameTable &name_table() {
+		static NameTable *table = new NameTable(); //(never freed, so names work during static destruction)
+		return *table;
+	}
+}
+
+Scene::Name::Name(std::string const &str) {
+	NameTable &table = name_table();
+	std::lock_guard< std::mutex > lock(table.mutex);
+	auto f = table.ids.find(str);
+	if (f != table.ids.end()) {
+		id = f->second;
+	} else {
+		id = uint32_t(table.strings.size());
+		table.strings.emplace_back(str);
+		table.ids.emplace(table.strings.back(), id);
+	}
+}
+
+std::string const &Scene::Name::str() const {
+	NameTable &table = name_table();
+	std::lock_guard< std::mutex > lock(table.mutex);
+	return table.strings[id];
+}
+
+//-------------------------
+
+static inline uint32_t name_slot(uint32_t id, uint32_t mask) {
+	return (id * 0x9e3779b1u) & mask;
+}
+
+//(shared by Scene::name_index and StaticPart::name_index)
+template< typename Transforms >
+static void build_name_index(Transforms &transforms, std::vector< std::pair< uint32_t, Scene::Transform * > > &name_index) {
+	//size the table to at least twice the number of transforms (a power of two, so slots are masked hashes):
+	uint32_t size = 16;
+	while (size < 2 * transforms.size()) size *= 2;
+	name_index.assign(size, std::make_pair(0, nullptr));
+	uint32_t mask = size - 1;
+
+	for (auto &t : transforms) {
+		if (t.name.id == 0) continue;
+		uint32_t slot = name_slot(t.name.id, mask);
+		while (name_index[slot].second != nullptr && name_index[slot].first != t.name.id) {
+			slot = (slot + 1) & mask;
+		}
+		if (name_index[slot].second == nullptr) {
+			name_index[slot] = std::make_pair(t.name.id, &t); //(only the first transform with a name is indexed)
+		}
+	}
+}
+
+static Scene::Transform *find_in_name_index(std::vector< std::pair< uint32_t, Scene::Transform * > > const &name_index, Scene::Name const &name) {
+	if (name_index.empty() || name.id == 0) return nullptr;
+	uint32_t mask = uint32_t(name_index.size()) - 1;
+	uint32_t slot = name_slot(name.id, mask);
+	while (name_index[slot].second != nullptr) {
+		if (name_index[slot].first == name.id) return name_index[slot].second;
+		slot = (slot + 1) & mask;
+	}
+	return nullptr;
+}
+
+void Scene::index_names() {
+	build_name_index(transforms, name_index);
+}
+
+Scene::Transform *Scene::find_transform(Name const &name) {
+	if (Transform *found = find_in_name_index(name_index, name)) return found;
+	//(static transforms are shared with other scenes; see the warning on StaticPart)
+	if (static_part) return find_in_name_index(static_part->name_index, name);
+	return nullptr;
+}
+
+Scene::Transform const *Scene::find_transform(Name const &name) const {
+	return const_cast< Scene * >(this)->find_transform(name);
+}
+
+uint32_t Scene::find_transforms(std::initializer_list< std::pair< Name, Transform ** > > const &queries) {
+	uint32_t found = 0;
+	for (auto const &query : queries) {
+		assert(query.second);
+		*query.second = find_transform(query.first);
+		if (*query.second) found += 1;
+	}
+	return found;
+}
+
+//-------------------------
+
+//Transform-to-transform mappings (built when copying or moving transforms) are tables sorted by address:
+// (one allocation, where an unordered_map would make one per transform)
+typedef std::vector< std::pair< Scene::Transform const *, Scene::Transform * > > TransformMap;
+
+static std::less< Scene::Transform const * > const before; //(std::less, since '<' on unrelated pointers isn't guaranteed to be a total order)
+
+static void sort_map(TransformMap &map) {
+	std::sort(map.begin(), map.end(), [](auto const &a, auto const &b) {
+		return before(a.first, b.first);
+	});
+}
+
+//returns the transform 'from' maps to, or nullptr if it isn't in the map:
+static Scene::Transform *find_in_map(TransformMap const &map, Scene::Transform const *from) {
+	auto f = std::lower_bound(map.begin(), map.end(), from, [](auto const &entry, Scene::Transform const *t) {
+		return before(entry.first, t);
+	});
+	if (f == map.end() || f->first != from) return nullptr;
+	return f->second;
+}
+
+bool Scene::StaticPart::contains(Transform const *transform) const {
+	return std::binary_search(sorted_transforms.begin(), sorted_transforms.end(), transform, before);
+}
+
+void Scene::partition(std::vector< Transform const * > const &moving_) {
+	std::vector< Transform const * > moving = moving_;
+
+	//static transforms can't be re-marked in place (the static part is shared), so copy them back first:
+	thaw(&moving);
+
+	//entities move too (so anything parented to one does):
+	entities.for_each([&](Entity &entity) {
+		entity.transform.is_static = false;
+		moving.emplace_back(&entity.transform);
+	});
+	std::sort(moving.begin(), moving.end(), before);
+
+	//a transform is static unless it or one of its ancestors moves:
+	for (auto &t : transforms) {
+		t.is_static = true;
+		for (Transform const *at = &t; at; at = at->parent) {
+			if (std::binary_search(moving.begin(), moving.end(), at, before)) {
+				t.is_static = false;
+				break;
+			}
+		}
+	}
+
+	bake_static();
+}
+
+void Scene::bake_static() {
+	thaw();
+
+	auto part = std::make_shared< StaticPart >();
+
+	//copy static transforms (in order) into the new static part:
+	TransformMap moved;
+	for (auto const &t : transforms) {
+		if (!t.is_static) continue;
+		assert(!t.parent || t.parent->is_static); //(the static part can't point back into the scene)
+		part->transforms.emplace_back();
+		part->transforms.back().name = t.name;
+		part->transforms.back().position = t.position;
+		part->transforms.back().rotation = t.rotation;
+		part->transforms.back().scale = t.scale;
+		part->transforms.back().is_static = true;
+		part->transforms.back().parent = t.parent; //will update later
+		moved.emplace_back(&t, &part->transforms.back());
+	}
+	sort_map(moved);
+	auto remap = [&](Transform *t) -> Transform * {
+		Transform *to = find_in_map(moved, t);
+		return (to ? to : t);
+	};
+
+	//(a static transform's ancestors are all static, so these all end up inside the static part)
+	for (auto &t : part->transforms) {
+		t.parent = remap(t.parent);
+	}
+
+	//move drawables on static transforms, baking their matrices:
+	for (auto const &drawable : drawables) {
+		assert(drawable.transform);
+		if (!drawable.transform->is_static) continue;
+		part->drawables.emplace_back(drawable);
+		part->drawables.back().transform = remap(drawable.transform);
+		part->object_to_world.emplace_back(part->drawables.back().transform->make_local_to_world());
+	}
+	drawables.remove_if([](Drawable const &drawable) {
+		return drawable.transform->is_static;
+	});
+
+	//point everything left in the scene at the moved transforms, then drop the originals:
+	for (auto &t : transforms) {
+		t.parent = remap(t.parent);
+	}
+	for (uint32_t i = 0; i < entities.slots; ++i) {
+		Transform &t = entities[i].transform;
+		t.parent = remap(t.parent);
+	}
+	for (auto &c : cameras) {
+		c.transform = remap(c.transform);
+	}
+	for (auto &l : lights) {
+		l.transform = remap(l.transform);
+	}
+	transforms.remove_if([](Transform const &t) {
+		return t.is_static;
+	});
+
+	build_name_index(part->transforms, part->name_index);
+	part->sorted_transforms.reserve(moved.size());
+	for (auto const &m : moved) {
+		part->sorted_transforms.emplace_back(m.second);
+	}
+	std::sort(part->sorted_transforms.begin(), part->sorted_transforms.end(), before);
+
+	static_part = part;
+	index_names();
+}
+
+void Scene::thaw(std::vector< Transform const * > *remap_) {
+	if (!static_part) return;
+	StaticPart const &part = *static_part;
+
+	//copy static transforms (in order) back into the scene:
+	TransformMap copied;
+	copied.reserve(part.transforms.size());
+	for (auto const &t : part.transforms) {
+		transforms.emplace_back();
+		transforms.back().name = t.name;
+		transforms.back().position = t.position;
+		transforms.back().rotation = t.rotation;
+		transforms.back().scale = t.scale;
+		transforms.back().is_static = t.is_static;
+		transforms.back().parent = t.parent; //will update later
+		copied.emplace_back(&t, &transforms.back());
+	}
+	sort_map(copied);
+	auto remap = [&](Transform *t) -> Transform * {
+		Transform *to = find_in_map(copied, t);
+		return (to ? to : t);
+	};
+
+	for (auto &t : transforms) {
+		t.parent = remap(t.parent);
+	}
+	for (uint32_t i = 0; i < entities.slots; ++i) {
+		Transform &t = entities[i].transform;
+		t.parent = remap(t.parent);
+	}
+	for (auto &d : drawables) {
+		d.transform = remap(d.transform); //(drawables added since partitioning may sit on static transforms)
+	}
+	for (auto const &drawable : part.drawables) {
+		drawables.emplace_back(drawable);
+		drawables.back().transform = remap(drawable.transform);
+	}
+	for (auto &c : cameras) {
+		c.transform = remap(c.transform);
+	}
+	for (auto &l : lights) {
+		l.transform = remap(l.transform);
+	}
+	if (remap_) {
+		for (auto &t : *remap_) {
+			if (Transform *to = find_in_map(copied, t)) t = to;
+		}
+	}
+
+	static_part.reset();
+	index_names();
+}
+
+//-------------------------
+
+Scene::NodePool::~NodePool() {
+	for (char *block : blocks) {
+		::operator delete(block);
+	}
+}
+
+void *Scene::NodePool::allocate(size_t size) {
+	size = (size + Alignment - 1) / Alignment * Alignment;
+	for (auto &free_list : free_lists) {
+		if (free_list.first == size && free_list.second) {
+			FreeNode *node = free_list.second;
+			free_list.second = node->next;
+			return node;
+		}
+	}
+	if (block_used + size > BlockSize) {
+		blocks.emplace_back(static_cast< char * >(::operator new(BlockSize)));
+		block_used = 0;
+	}
+	void *node = blocks.back() + block_used;
+	block_used += size;
+	return node;
+}
+
+void Scene::NodePool::deallocate(void *ptr, size_t size) {
+	size = (size + Alignment - 1) / Alignment * Alignment;
+	FreeNode *node = static_cast< FreeNode * >(ptr);
+	for (auto &free_list : free_lists) {
+		if (free_list.first == size) {
+			node->next = free_list.second;
+			free_list.second = node;
+			return;
+		}
+	}
+	node->next = nullptr;
+	free_lists.emplace_back(size, node);
+}
+
+uint32_t Scene::EntityPool::spawn() {
+	uint32_t index;
+	if (free_list != -1U) {
+		index = free_list;
+		free_list = (*this)[index].next_free;
+	} else {
+		if (slots == uint32_t(chunks.size()) * ChunkSize) {
+			chunks.emplace_back(std::make_unique< Entity[] >(ChunkSize));
+		}
+		index = slots;
+		slots += 1;
+	}
+
+	Entity &entity = (*this)[index];
+	entity.transform.name = Name();
+	entity.transform.position = glm::vec3(0.0f);
+	entity.transform.rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	entity.transform.scale = glm::vec3(1.0f);
+	entity.transform.parent = nullptr;
+	entity.transform.is_static = false;
+	entity.drawable.pipeline = Drawable::Pipeline();
+	entity.drawable.lods = nullptr;
+	entity.drawable.lod_count = 0;
+	entity.drawable.bounds_center = glm::vec3(0.0f);
+	entity.drawable.bounds_radius = 0.0f;
+	entity.alive = true;
+	entity.next_free = -1U;
+	alive += 1;
+
+	return index;
+}
+
+void Scene::EntityPool::despawn(uint32_t index) {
+	if (!(index < slots && (*this)[index].alive)) {
+		throw std::runtime_error("Despawning entity " + std::to_string(index) + ", which isn't alive.");
+	}
+	Entity &entity = (*this)[index];
+	entity.alive = false;
+	entity.next_free = free_list;
+	free_list = index;
+	alive -= 1;
+}
+
+void Scene::EntityPool::clear() {
+	for (uint32_t i = 0; i < slots; ++i) {
+		(*this)[i].alive = false;
+		(*this)[i].next_free = -1U;
+	}
+	slots = 0;
+	alive = 0;
+	free_list = -1U;
+}
+
 void Scene::draw(Camera const &camera) const {
 	assert(camera.transform);
 	glm::mat4 world_to_clip = camera.make_projection() * glm::mat4(camera.transform->make_world_to_local());
@@ -92,8 +510,32 @@ void Scene::draw(Camera const &camera) const {
 
 void Scene::draw(glm::mat4 const &world_to_clip, glm::mat4 const&world_to_view, glm::mat4x3 const &world_to_light) const {
 
-	//Iterate through all drawables, sending each one to OpenGL:
+	//Compute the object-to-world matrices of dynamic drawables up front (spread over the job system's threads):
+	// (drawables outside the static part -- all of them, if the scene isn't partitioned -- are dynamic)
+	// (scratch arrays live in the frame arena, so this doesn't touch the heap)
+	frame_vector< Drawable const * > scratch_drawables;
+	scratch_drawables.reserve(drawables.size() + entities.alive);
 	for (auto const &drawable : drawables) {
+		assert(drawable.transform); //drawables *must* have a transform
+		scratch_drawables.emplace_back(&drawable);
+	}
+	entities.for_each([&](Entity const &entity) {
+		scratch_drawables.emplace_back(&entity.drawable);
+	});
+	frame_vector< glm::mat4x3 > scratch_object_to_world(scratch_drawables.size());
+	Jobs::parallel_for(0, uint32_t(scratch_drawables.size()), 64, [&](uint32_t first, uint32_t last) {
+		for (uint32_t i = first; i < last; ++i) {
+			scratch_object_to_world[i] = scratch_drawables[i]->transform->make_local_to_world();
+		}
+	});
+
+	//static drawables (with baked matrices) go first:
+	uint32_t static_count = (static_part ? uint32_t(static_part->drawables.size()) : 0);
+	uint32_t total_count = static_count + uint32_t(scratch_drawables.size());
+
+	//Iterate through all drawables, sending each one to OpenGL:
+	for (uint32_t d = 0; d < total_count; ++d) {
+		Scene::Drawable const &drawable = (d < static_count ? static_part->drawables[d] : *scratch_drawables[d - static_count]);
 		//Reference to drawable's pipeline for convenience:
 		Scene::Drawable::Pipeline const &pipeline = drawable.pipeline;
 
@@ -114,8 +556,7 @@ void Scene::draw(glm::mat4 const &world_to_clip, glm::mat4 const&world_to_view,
 		//Configure program uniforms:
 
 		//the object-to-world matrix is used in all three of these uniforms:
-		assert(drawable.transform); //drawables *must* have a transform
-		glm::mat4x3 object_to_world = drawable.transform->make_local_to_world();
+		glm::mat4x3 const &object_to_world = (d < static_count ? static_part->object_to_world[d] : scratch_object_to_world[d - static_count]);
 		glm::mat4x3 object_to_view = world_to_view * glm::mat4(object_to_world);
 		glUniformMatrix4x3fv(pipeline.OBJECT_TO_VIEW_mat4x3, 1, GL_FALSE,  glm::value_ptr(object_to_view));
 
@@ -150,8 +591,24 @@ void Scene::draw(glm::mat4 const &world_to_clip, glm::mat4 const&world_to_view,
 			}
 		}
 
+		//pick a level of detail:
+		GLuint start = pipeline.start;
+		GLuint count = pipeline.count;
+		if (drawable.lod_count > 0) {
+			//(object_to_view is a rotation and translation of object_to_world, so it has the same scale)
+			float scale = std::max(glm::length(object_to_view[0]), std::max(glm::length(object_to_view[1]), glm::length(object_to_view[2])));
+			glm::vec3 center = object_to_view * glm::vec4(drawable.bounds_center, 1.0f);
+			float distance = std::max(0.0f, glm::length(center) - scale * drawable.bounds_radius);
+			for (Drawable::LOD const *lod = drawable.lods; lod != drawable.lods + drawable.lod_count; ++lod) {
+				if (distance <= lod_fog_distance && lod->error * scale > lod_error * distance) break;
+				start = lod->start;
+				count = lod->count;
+			}
+		}
+
 		//draw the object:
-		glDrawArrays(pipeline.type, pipeline.start, pipeline.count);
+		glDrawArrays(pipeline.type, start, count);
+		Profiler::count_draw_call();
 
 		//un-bind textures:
 		for (uint32_t i = 0; i < Drawable::Pipeline::TextureCount; ++i) {
@@ -174,7 +631,8 @@ void Scene::draw(glm::mat4 const &world_to_clip, glm::mat4 const&world_to_view,
 void Scene::load(std::string const &filename,
 	std::function< void(Scene &, Transform *, std::string const &) > const &on_drawable) {
 
-	std::ifstream file(filename, std::ios::binary);
+	std::unique_ptr< std::istream > file_ptr = open_data(filename); //(may come from a mounted bundle)
+	std::istream &file = *file_ptr;
 
 	std::vector< char > names;
 	read_chunk(file, "str0", &names);
@@ -240,7 +698,7 @@ void Scene::load(std::string const &filename,
 		}
 
 		if (h.name_begin <= h.name_end && h.name_end <= names.size()) {
-			t->name = std::string(names.begin() + h.name_begin, names.begin() + h.name_end);
+			t->name = Name(std::string(names.begin() + h.name_begin, names.begin() + h.name_end));
 		} else {
 				throw std::runtime_error("scene file '" + filename + "' contains hierarchy entry with invalid name indices");
 		}
@@ -253,6 +711,9 @@ void Scene::load(std::string const &filename,
 	}
 	assert(hierarchy_transforms.size() == hierarchy.size());
 
+	//(so that on_drawable can use find_transform)
+	index_names();
+
 	for (auto const &m : meshes) {
 		if (m.transform >= hierarchy_transforms.size()) {
 			throw std::runtime_error("scene file '" + filename + "' contains mesh entry with invalid transform index (" + std::to_string(m.transform) + ")");
@@ -309,6 +770,8 @@ void Scene::load(std::string const &filename,
 	//load any extra that a subclass wants:
 	load_extra(file, names, hierarchy_transforms);
 
+	index_names(); //(new transforms aren't static, so new drawables are dynamic)
+
 	if (file.peek() != EOF) {
 		std::cerr << "WARNING: trailing data in scene file '" << filename << "'" << std::endl;
 	}
@@ -334,15 +797,18 @@ Scene &Scene::operator=(Scene const &other) {
 
 void Scene::set(Scene const &other, std::unordered_map< Transform const *, Transform * > *transform_map_) {
 
-	std::unordered_map< Transform const *, Transform * > t2t_temp;
-	std::unordered_map< Transform const *, Transform * > &transform_to_transform = *(transform_map_ ? transform_map_ : &t2t_temp);
+	//share other's static part (it never changes, so there's nothing to copy):
+	static_part = other.static_part;
 
-	transform_to_transform.clear();
+	//mapping from other's (dynamic) transforms to ours:
+	TransformMap transform_to_transform;
+	transform_to_transform.reserve(1 + other.transforms.size() + other.entities.slots);
 
 	//null transform maps to itself:
-	transform_to_transform.insert(std::make_pair(nullptr, nullptr));
+	transform_to_transform.emplace_back(nullptr, nullptr);
 
 	//Copy transforms and store mapping:
+	// (clear() hands nodes back to our pool, so re-setting a scene reuses them)
 	transforms.clear();
 	for (auto const &t : other.transforms) {
 		transforms.emplace_back();
@@ -350,33 +816,84 @@ void Scene::set(Scene const &other, std::unordered_map< Transform const *, Trans
 		transforms.back().position = t.position;
 		transforms.back().rotation = t.rotation;
 		transforms.back().scale = t.scale;
+		transforms.back().is_static = t.is_static;
 		transforms.back().parent = t.parent; //will update later
 
 		//store mapping between transforms old and new:
-		auto ret = transform_to_transform.insert(std::make_pair(&t, &transforms.back()));
-		assert(ret.second);
+		transform_to_transform.emplace_back(&t, &transforms.back());
+	}
+
+	//Copy entity pool slot-for-slot (so indices carry over) and store mapping:
+	entities.clear();
+	while (entities.chunks.size() * EntityPool::ChunkSize < other.entities.slots) {
+		entities.chunks.emplace_back(std::make_unique< Entity[] >(EntityPool::ChunkSize));
+	}
+	entities.slots = other.entities.slots;
+	entities.alive = other.entities.alive;
+	entities.free_list = other.entities.free_list;
+	for (uint32_t i = 0; i < other.entities.slots; ++i) {
+		Entity const &from = other.entities[i];
+		Entity &to = entities[i];
+		to.transform.name = from.transform.name;
+		to.transform.position = from.transform.position;
+		to.transform.rotation = from.transform.rotation;
+		to.transform.scale = from.transform.scale;
+		to.transform.is_static = from.transform.is_static;
+		to.transform.parent = from.transform.parent; //will update later
+		to.drawable.pipeline = from.drawable.pipeline;
+		to.drawable.lods = from.drawable.lods;
+		to.drawable.lod_count = from.drawable.lod_count;
+		to.drawable.bounds_center = from.drawable.bounds_center;
+		to.drawable.bounds_radius = from.drawable.bounds_radius;
+		to.alive = from.alive;
+		to.next_free = from.next_free;
+
+		transform_to_transform.emplace_back(&from.transform, &to.transform);
+	}
+
+	sort_map(transform_to_transform);
+	auto lookup = [&](Transform *from) -> Transform * {
+		if (Transform *to = find_in_map(transform_to_transform, from)) return to;
+		if (from == nullptr) return nullptr;
+		//static transforms are shared, so map to themselves:
+		if (static_part && static_part->contains(from)) return from;
+		throw std::runtime_error("Scene references a transform that isn't part of the scene.");
+	};
+
+	if (transform_map_) {
+		transform_map_->clear();
+		transform_map_->insert(transform_to_transform.begin(), transform_to_transform.end());
 	}
 
 	//update transform parents:
 	for (auto &t : transforms) {
-		t.parent = transform_to_transform.at(t.parent);
+		t.parent = lookup(t.parent);
+	}
+	for (uint32_t i = 0; i < entities.slots; ++i) {
+		Transform &t = entities[i].transform;
+		t.parent = lookup(t.parent);
 	}
 
-	//copy other's drawables, updating transform pointers:
+	index_names();
+
+	//copy other's (dynamic) drawables, updating transform pointers:
 	drawables = other.drawables;
 	for (auto &d : drawables) {
-		d.transform = transform_to_transform.at(d.transform);
+		d.transform = lookup(d.transform);
 	}
 
 	//copy other's cameras, updating transform pointers:
 	cameras = other.cameras;
 	for (auto &c : cameras) {
-		c.transform = transform_to_transform.at(c.transform);
+		c.transform = lookup(c.transform);
 	}
 
 	//copy other's lights, updating transform pointers:
 	lights = other.lights;
 	for (auto &l : lights) {
-		l.transform = transform_to_transform.at(l.transform);
+		l.transform = lookup(l.transform);
 	}
+
+	lod_error = other.lod_error;
+	lod_fog_distance = other.lod_fog_distance;
 }
@@ -8,24 +8,119 @@
  *  - Camera information (via "Camera")
  *  - Light information (via "Light")
  *
+ * Objects spawned while the game runs (goals, mines, ...) can instead live in
+ * the scene's entity pool ("Entity" / "entities"), which gives each one a
+ * transform and a drawable in one index-addressed slot.
+ *
+ * Transform names are interned ("Name"), and each scene keeps an index from
+ * names to transforms, so find_transform() is a hash lookup rather than a
+ * scan with string compares.
+ *
+ * Drawables may have simplified versions of their geometry ("lods"); draw()
+ * picks the coarsest one whose error would look small from the camera.
+ *
+ * Most of a level never moves: partition() marks transforms static or dynamic,
+ * and moves the static transforms -- along with their drawables and baked world
+ * matrices -- into an immutable "StaticPart". From then on draw() only computes
+ * matrices for the dynamic drawables, and copies of the scene share the static
+ * part (copy-on-write instancing): copying a partitioned level only copies its
+ * dynamic transforms, drawables, cameras, lights, and entities.
+ *
+ * Each scene allocates its list nodes from its own "NodePool", so loading or
+ * copying a scene (e.g., making a fresh copy of a level to play) makes a few
+ * block-sized allocations rather than one per object.
+ *
  */
 
 #include "GL.hpp"
+#include "Mesh.hpp"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include <cstddef>
 #include <list>
 #include <memory>
 #include <functional>
+#include <initializer_list>
+#include <limits>
 #include <string>
 #include <vector>
 #include <unordered_map>
 
 struct Scene {
+	//Chunked allocator for a scene's list nodes:
+	// nodes are bump-allocated from large blocks; freed nodes go on a free list (per node size) for reuse.
+	// Blocks are only released when the pool is destroyed (i.e., along with the scene).
+	// (not thread-safe -- like the rest of Scene, use each scene from one thread at a time)
+	struct NodePool {
+		NodePool() = default;
+		NodePool(NodePool const &) = delete;
+		NodePool &operator=(NodePool const &) = delete;
+		~NodePool();
+
+		void *allocate(size_t size);
+		void deallocate(void *node, size_t size);
+
+		static constexpr size_t BlockSize = 1 << 14;
+		static constexpr size_t Alignment = alignof(std::max_align_t);
+		std::vector< char * > blocks;
+		size_t block_used = BlockSize; //bytes used in blocks.back()
+		struct FreeNode { FreeNode *next; };
+		std::vector< std::pair< size_t, FreeNode * > > free_lists; //(node size, most recently freed node)
+	};
+
+	//STL allocator that allocates single nodes from a NodePool (and anything else from the heap):
+	template< typename T >
+	struct NodeAllocator {
+		using value_type = T;
+
+		NodeAllocator(std::shared_ptr< NodePool > const &pool_) : pool(pool_) { }
+		template< typename U >
+		NodeAllocator(NodeAllocator< U > const &other) : pool(other.pool) { }
+
+		T *allocate(size_t n) {
+			if (n == 1 && sizeof(T) <= NodePool::BlockSize / 4 && alignof(T) <= NodePool::Alignment) {
+				return static_cast< T * >(pool->allocate(sizeof(T)));
+			}
+			return static_cast< T * >(::operator new(n * sizeof(T)));
+		}
+		void deallocate(T *ptr, size_t n) {
+			if (n == 1 && sizeof(T) <= NodePool::BlockSize / 4 && alignof(T) <= NodePool::Alignment) {
+				pool->deallocate(ptr, sizeof(T));
+			} else {
+				::operator delete(ptr);
+			}
+		}
+
+		template< typename U >
+		bool operator==(NodeAllocator< U > const &other) const { return pool == other.pool; }
+		template< typename U >
+		bool operator!=(NodeAllocator< U > const &other) const { return pool != other.pool; }
+
+		std::shared_ptr< NodePool > pool;
+	};
+
+	template< typename T >
+	using List = std::list< T, NodeAllocator< T > >;
+
+	//A 'Name' is an interned string: each distinct string is stored once, in a table shared by all scenes,
+	// and names compare (and hash) as integer ids. Make Names for strings you look up often once, up front:
+	//   static Scene::Name const Sub("Sub"); ... scene.find_transform(Sub)
+	struct Name {
+		Name() = default; //the empty name
+		explicit Name(std::string const &str); //(thread-safe; takes a lock)
+		std::string const &str() const; //(thread-safe; takes a lock)
+
+		bool operator==(Name const &other) const { return id == other.id; }
+		bool operator!=(Name const &other) const { return id != other.id; }
+
+		uint32_t id = 0; //index in the table; 0 is the empty name
+	};
+
 	struct Transform {
 		//Transform names are useful for debugging and looking up locations in a loaded scene:
-		std::string name;
+		Name name;
 
 		//The core function of a transform is to store a transformation in the world:
 		glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f);
@@ -35,6 +130,10 @@ struct Scene {
 		//The transform above may be relative to some parent transform:
 		Transform *parent = nullptr;
 
+		//Set by Scene::partition() for transforms that (along with all their ancestors) never move:
+		// (static transforms live in the scene's shared static part; to move one, partition() again without it)
+		bool is_static = false;
+
 		//It is often convenient to construct matrices representing this transformation:
 		// ..relative to its parent:
 		glm::mat4x3 make_local_to_parent() const;
@@ -84,6 +183,16 @@ struct Scene {
 				GLenum target = GL_TEXTURE_2D;
 			} textures[TextureCount];
 		} pipeline;
+
+		//(optional) simplified versions of pipeline's vertex range, from most to least detailed:
+		// draw() uses the coarsest level whose error is small enough from where the camera is (see Scene::lod_error)
+		// (not owned: usually points into a MeshBuffer's lods -- see MeshBuffer::lods_of -- which must outlive the drawable)
+		using LOD = Mesh::LOD;
+		LOD const *lods = nullptr;
+		uint32_t lod_count = 0;
+		//object-space bounding sphere of the geometry (for judging distance to the camera when choosing a level):
+		glm::vec3 bounds_center = glm::vec3(0.0f);
+		float bounds_radius = 0.0f;
 	};
 
 	struct Camera {
@@ -121,11 +230,122 @@ struct Scene {
 		float spot_fov = glm::radians(45.0f); //spot cone fov (in radians)
 	};
 
+	//An 'Entity' is an object spawned at runtime: a transform, and a drawable attached to it:
+	struct Entity {
+		Entity() : drawable(&transform) { }
+		Entity(Entity const &) = delete;
+
+		Transform transform;
+		Drawable drawable; //(drawable.transform is always &transform)
+
+		bool alive = false;
+		uint32_t next_free = -1U; //next slot on the free list (if not alive)
+	};
+
+	//An 'EntityPool' stores entities in index-addressed slots:
+	// - spawn() and despawn() are O(1); despawned slots go on a free list and are reused.
+	// - slots live in fixed-size chunks that never move, so pointers to entities (and their transforms) stay valid as the pool grows.
+	// - copying a scene copies its pool slot-for-slot, so entity indices mean the same thing in the copy.
+	struct EntityPool {
+		static constexpr uint32_t ChunkSize = 256;
+
+		//make an entity (with default transform and drawable pipeline); returns its index:
+		uint32_t spawn();
+		//remove entity 'index' (which must be alive):
+		void despawn(uint32_t index);
+		//remove all entities (keeping storage for reuse):
+		void clear();
+
+		//look up slot 'index' (which must be less than 'slots'):
+		Entity &operator[](uint32_t index) { return chunks[index / ChunkSize][index % ChunkSize]; }
+		Entity const &operator[](uint32_t index) const { return chunks[index / ChunkSize][index % ChunkSize]; }
+
+		//call fn(entity) for each living entity, in index order:
+		template< typename F >
+		void for_each(F const &fn) const {
+			for (uint32_t i = 0; i < slots; ++i) {
+				Entity const &entity = (*this)[i];
+				if (entity.alive) fn(entity);
+			}
+		}
+		template< typename F >
+		void for_each(F const &fn) {
+			for (uint32_t i = 0; i < slots; ++i) {
+				Entity &entity = (*this)[i];
+				if (entity.alive) fn(entity);
+			}
+		}
+
+		std::vector< std::unique_ptr< Entity[] > > chunks;
+		uint32_t slots = 0; //slots in use (alive or on the free list); the rest of the last chunk is untouched
+		uint32_t alive = 0; //living entities
+		uint32_t free_list = -1U; //most recently despawned slot
+	};
+
+	//A 'StaticPart' holds the transforms that never move, the drawables attached to them, and those drawables' baked
+	// object-to-world matrices. It is made by partition() (or bake_static()) and never changed afterward, so scene
+	// copies share it. Don't modify anything in it -- even through the non-const Transform pointers that drawables,
+	// cameras, lights, child transforms, and find_transform() may hold -- instead, thaw() the scene, edit, and re-bake.
+	struct StaticPart {
+		StaticPart() = default;
+		StaticPart(StaticPart const &) = delete;
+		StaticPart &operator=(StaticPart const &) = delete;
+
+		//(declared after 'pool', so they are destroyed first)
+		std::shared_ptr< NodePool > pool = std::make_shared< NodePool >();
+		List< Transform > transforms{NodeAllocator< Transform >(pool)};
+		std::vector< Drawable > drawables; //drawables on 'transforms'...
+		std::vector< glm::mat4x3 > object_to_world; //...and their object-to-world matrices
+
+		std::vector< std::pair< uint32_t, Transform * > > name_index; //(same layout as Scene::name_index)
+		std::vector< Transform const * > sorted_transforms; //addresses of 'transforms', sorted (for contains())
+		bool contains(Transform const *transform) const;
+	};
+
 	//Scenes, of course, may have many of the above objects:
-	std::list< Transform > transforms;
-	std::list< Drawable > drawables;
-	std::list< Camera > cameras;
-	std::list< Light > lights;
+	// (declared after 'pool', so they are destroyed first)
+	// (once the scene is partitioned, 'transforms' and 'drawables' only hold its dynamic ones -- see StaticPart)
+	std::shared_ptr< NodePool > pool = std::make_shared< NodePool >();
+	List< Transform > transforms{NodeAllocator< Transform >(pool)};
+	List< Drawable > drawables{NodeAllocator< Drawable >(pool)};
+	List< Camera > cameras{NodeAllocator< Camera >(pool)};
+	List< Light > lights{NodeAllocator< Light >(pool)};
+	EntityPool entities;
+	std::shared_ptr< StaticPart const > static_part; //(null until partitioned; shared by copies)
+
+	//Find the (first) transform named 'name', or nullptr if there is none:
+	// (looks in 'transforms' and then the static part, via their name indices -- not in 'entities')
+	Transform *find_transform(Name const &name);
+	Transform const *find_transform(Name const &name) const;
+
+	//Find several transforms at once, e.g. find_transforms({ {Sub, &sub}, {Floor, &floor} }):
+	// (sets each pointer to the found transform, or nullptr; returns the number found)
+	uint32_t find_transforms(std::initializer_list< std::pair< Name, Transform ** > > const &queries);
+
+	//Static/dynamic partitioning:
+	// partition(moving) marks every transform that isn't in 'moving' -- and isn't below one of them in the
+	// hierarchy -- static, then calls bake_static(). Entities are always dynamic.
+	// bake_static() moves the static transforms and their drawables into a new 'static_part', baking the drawables'
+	// world matrices, which draw() then reuses. (Pointers to the moved transforms and drawables change, so look up
+	// transforms after partitioning.)
+	// thaw() copies the static part back into 'transforms' and 'drawables' (appended, in the static part's order)
+	// and drops it, e.g. to edit static geometry; 'remap' pointers that pointed into the static part are updated.
+	// Drawables added after partitioning are dynamic; call partition() again to change what is static.
+	void partition(std::vector< Transform const * > const &moving);
+	void bake_static();
+	void thaw(std::vector< Transform const * > *remap = nullptr);
+
+	//Level-of-detail selection (for drawables with 'lods'):
+	// draw() uses the coarsest level whose (world-space) error is at most lod_error times the distance from the camera
+	// to the drawable's bounding sphere -- i.e., lod_error is an angle in radians (0.001 is about a pixel at 1080p with a
+	// 60 degree field of view). Past lod_fog_distance (e.g., where fog hides everything) the coarsest level is always used.
+	float lod_error = 0.001f;
+	float lod_fog_distance = std::numeric_limits< float >::infinity();
+
+	//Index of 'transforms' by name: open addressing with linear probing (empty slots have a null transform).
+	// load(), set(), and bake_static() rebuild it; call index_names() after adding or renaming transforms.
+	std::vector< std::pair< uint32_t, Transform * > > name_index;
+	void index_names();
 
 	//The "draw" function provides a convenient way to pass all the things in a scene to OpenGL:
 	void draw(Camera const &camera) const;
@@ -133,6 +353,30 @@ struct Scene {
 	//..sometimes, you want to draw with a custom projection matrix and/or light space:
 	void draw(glm::mat4 const &world_to_clip, glm::mat4 const &world_to_view, glm::mat4x3 const &world_to_light = glm::mat4x3(1.0f)) const;
 
+	//The parts of a transform that change as a simulation runs:
+	struct TransformState {
+		glm::vec3 position;
+		glm::quat rotation;
+		glm::vec3 scale;
+	};
+
+	//An 'Interpolator' smooths motion between fixed-rate simulation steps (see Mode::fixed_timestep):
+	// call begin_step() before and end_step() after each step, and apply(alpha) before drawing.
+	// apply() leaves blended values in the transforms until the next begin_step() puts the simulated ones back.
+	struct Interpolator {
+		std::vector< Transform * > transforms; //transforms to interpolate
+		std::vector< TransformState > previous, current; //states before and after the most recent step
+		bool applied = false; //transforms currently hold blended (not simulated) states
+
+		void begin_step();
+		void end_step();
+		void apply(float alpha); //alpha in [0,1]: fraction of a step since the most recent one
+	};
+
+	//set 'to' (e.g., transforms in a copy of the scene) to states blended between 'a' and 'b':
+	// (does nothing unless all three are the same size)
+	static void blend_transforms(std::vector< TransformState > const &a, std::vector< TransformState > const &b, float alpha, std::vector< Transform * > const &to);
+
 	//add transforms/objects/cameras from a scene file to this scene:
 	// the 'on_drawable' callback gives your code a chance to look up mesh data and make Drawables:
 	// throws on file format errors
@@ -146,6 +390,7 @@ struct Scene {
 
 	//empty scene:
 	Scene() = default;
+	virtual ~Scene() = default; //(subclasses may be deleted through a Scene pointer, e.g. by AssetCache)
 
 	//load a scene:
 	Scene(std::string const &filename, std::function< void(Scene &, Transform *, std::string const &) > const &on_drawable);
@@ -154,5 +399,9 @@ struct Scene {
 	Scene(Scene const &); //...as a constructor
 	Scene &operator=(Scene const &); //...as scene = scene
 	//... as a set() function that optionally returns the transform->transform mapping:
+	// (copies keep transforms in the same order and entities in the same slots, so callers can
+	//  usually match up transforms by walking both scenes instead of asking for the map)
+	// (the copy shares 'static_part' -- so copying a partitioned scene costs only as much as its dynamic part --
+	//  and static transforms aren't in the map, since they map to themselves)
 	void set(Scene const &, std::unordered_map< Transform const *, Transform * > *transform_map = nullptr);
 };
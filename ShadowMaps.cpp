@@ -0,0 +1,503 @@
+#include "ShadowMaps.hpp"
+
+#include "ShadowProgram.hpp"
+#include "LitColorTextureProgram.hpp"
+#include "FrameArena.hpp"
+#include "Profiler.hpp"
+#include "gl_errors.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+static constexpr uint32_t AtlasSize = ShadowMaps::SpotSize * ShadowMaps::AtlasTiles;
+
+static_assert(ShadowMaps::Cascades == 4 && ShadowMaps::SpotSlots == 16, "Map counts match lit_color_texture_program's uniform arrays.");
+
+//set up a depth texture for the shader to read with depth comparisons:
+// (outside the map counts as lit)
+static void set_shadow_parameters(GLenum target) {
+	glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	float border[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	glTexParameterfv(target, GL_TEXTURE_BORDER_COLOR, border);
+	glTexParameteri(target, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(target, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+}
+
+//make a depth-only framebuffer that draws into 'texture' (or, if 'layer' isn't -1, one layer of it):
+static GLuint make_framebuffer(GLuint texture, int32_t layer) {
+	GLuint framebuffer = 0;
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	if (layer == -1) {
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
+	} else {
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture, 0, layer);
+	}
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		throw std::runtime_error("ShadowMaps: depth-only framebuffer is incomplete (status " + std::to_string(status) + ").");
+	}
+	return framebuffer;
+}
+
+//inward-facing planes of the volume 'world_to_clip' maps to the clip cube (left, right, bottom, top, far, near):
+static void clip_planes(glm::mat4 const &world_to_clip, glm::vec4 (&planes)[6]) {
+	glm::mat4 rows = glm::transpose(world_to_clip);
+	planes[0] = rows[3] + rows[0];
+	planes[1] = rows[3] - rows[0];
+	planes[2] = rows[3] + rows[1];
+	planes[3] = rows[3] - rows[1];
+	planes[4] = rows[3] - rows[2];
+	planes[5] = rows[3] + rows[2];
+	for (auto &plane : planes) {
+		plane /= glm::length(glm::vec3(plane));
+	}
+}
+
+//fold 'data' into an FNV-1a hash:
+static uint64_t hash_bytes(uint64_t hash, void const *data, size_t size) {
+	unsigned char const *bytes = reinterpret_cast< unsigned char const * >(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+//rotation part of a light's transform, without scale (rows are the light's x, y, and z axes in world space):
+static glm::mat3 light_axes(glm::mat4x3 const &light_to_world) {
+	glm::vec3 z = glm::normalize(light_to_world[2]);
+	glm::vec3 x = glm::normalize(glm::cross(light_to_world[1], z));
+	glm::vec3 y = glm::cross(z, x);
+	return glm::transpose(glm::mat3(x, y, z));
+}
+
+ShadowMaps::ShadowMaps() {
+	glGenTextures(1, &cascade_texture);
+	glGenTextures(1, &cascade_static_texture);
+	for (GLuint texture : { cascade_texture, cascade_static_texture }) {
+		glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, CascadeSize, CascadeSize, Cascades, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+		set_shadow_parameters(GL_TEXTURE_2D_ARRAY);
+	}
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	glGenTextures(1, &spot_texture);
+	glGenTextures(1, &spot_static_texture);
+	for (GLuint texture : { spot_texture, spot_static_texture }) {
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, AtlasSize, AtlasSize, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+		set_shadow_parameters(GL_TEXTURE_2D);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	for (uint32_t c = 0; c < Cascades; ++c) {
+		cascade_framebuffers[c] = make_framebuffer(cascade_texture, int32_t(c));
+		cascade_static_framebuffers[c] = make_framebuffer(cascade_static_texture, int32_t(c));
+	}
+	spot_framebuffer = make_framebuffer(spot_texture, -1);
+	spot_static_framebuffer = make_framebuffer(spot_static_texture, -1);
+
+	GL_ERRORS();
+}
+
+ShadowMaps::~ShadowMaps() {
+	glDeleteFramebuffers(Cascades, cascade_framebuffers);
+	glDeleteFramebuffers(Cascades, cascade_static_framebuffers);
+	glDeleteFramebuffers(1, &spot_framebuffer);
+	glDeleteFramebuffers(1, &spot_static_framebuffer);
+	GLuint textures[4] = { cascade_texture, cascade_static_texture, spot_texture, spot_static_texture };
+	glDeleteTextures(4, textures);
+	cascade_texture = cascade_static_texture = spot_texture = spot_static_texture = 0;
+}
+
+void ShadowMaps::invalidate() {
+	static_part.reset();
+	for (auto &map : cascades) map = Map();
+	for (auto &map : spots) map = Map();
+	for (auto &light : spot_lights) light = nullptr;
+}
+
+int32_t ShadowMaps::spot_slot(Scene::Light const *light) const {
+	for (uint32_t s = 0; s < SpotSlots; ++s) {
+		if (spot_lights[s] == light) return int32_t(s);
+	}
+	return -1;
+}
+
+void ShadowMaps::update(Scene const &scene, Scene::Camera const &camera) {
+	assert(camera.transform);
+
+	static_redraws = 0;
+	dynamic_redraws = 0;
+	casters_drawn = 0;
+
+	GLuint program = (caster_program ? caster_program : lit_color_texture_program->program);
+
+	//----- gather casters -----
+	auto casts = [&](Scene::Drawable const &drawable) {
+		Scene::Drawable::Pipeline const &pipeline = drawable.pipeline;
+		return pipeline.program == program && pipeline.vao != 0 && pipeline.count != 0;
+	};
+	auto make_caster = [](Scene::Drawable const &drawable, glm::mat4x3 const &object_to_world) {
+		Caster caster;
+		caster.drawable = &drawable;
+		caster.object_to_world = object_to_world;
+		caster.center = object_to_world * glm::vec4(drawable.bounds_center, 1.0f);
+		caster.radius = std::numeric_limits< float >::infinity();
+		if (drawable.bounds_radius > 0.0f) {
+			float scale = std::max(glm::length(object_to_world[0]), std::max(glm::length(object_to_world[1]), glm::length(object_to_world[2])));
+			caster.radius = scale * drawable.bounds_radius;
+		}
+		return caster;
+	};
+
+	//static casters only change if the scene's static part does (i.e., it is re-partitioned):
+	if (static_part != scene.static_part) {
+		invalidate();
+		static_part = scene.static_part;
+		static_casters.clear();
+		if (static_part) {
+			for (size_t d = 0; d < static_part->drawables.size(); ++d) {
+				if (!casts(static_part->drawables[d])) continue;
+				static_casters.emplace_back(make_caster(static_part->drawables[d], static_part->object_to_world[d]));
+			}
+		}
+	}
+
+	dynamic_casters.clear();
+	auto add_dynamic = [&](Scene::Drawable const &drawable) {
+		if (!casts(drawable)) return;
+		dynamic_casters.emplace_back(make_caster(drawable, drawable.transform->make_local_to_world()));
+	};
+	for (Scene::Drawable const &drawable : scene.drawables) add_dynamic(drawable);
+	scene.entities.for_each([&](Scene::Entity const &entity) {
+		add_dynamic(entity.drawable);
+	});
+
+	//----- drawing helpers -----
+	//the level of detail to draw a caster at, if a map texel is 'texel' units across where it is:
+	// (the coarsest level whose error is smaller than a texel)
+	auto pick_level = [](Caster const &caster, float texel, GLuint *start, GLuint *count) {
+		Scene::Drawable const &drawable = *caster.drawable;
+		*start = drawable.pipeline.start;
+		*count = drawable.pipeline.count;
+		if (drawable.lod_count == 0) return;
+		float scale = std::max(glm::length(caster.object_to_world[0]), std::max(glm::length(caster.object_to_world[1]), glm::length(caster.object_to_world[2])));
+		for (Scene::Drawable::LOD const *lod = drawable.lods; lod != drawable.lods + drawable.lod_count; ++lod) {
+			if (lod->error * scale > texel) break;
+			*start = lod->start;
+			*count = lod->count;
+		}
+	};
+
+	//texel size at a caster: 'texel' units, plus 'per_distance' per unit of distance from 'eye':
+	struct Texel {
+		float texel;
+		float per_distance;
+		glm::vec3 eye;
+		float at(Caster const &caster) const {
+			return texel + per_distance * std::max(0.0f, glm::length(caster.center - eye) - caster.radius);
+		}
+	};
+
+	//is a caster inside the first 'plane_count' of 'planes'?
+	auto inside = [](Caster const &caster, glm::vec4 const (&planes)[6], uint32_t plane_count) {
+		for (uint32_t p = 0; p < plane_count; ++p) {
+			if (glm::dot(glm::vec3(planes[p]), caster.center) + planes[p].w < -caster.radius) return false;
+		}
+		return true;
+	};
+
+	//draw a caster (with shadow_program already bound):
+	auto draw = [&](Caster const &caster, glm::mat4 const &world_to_clip, GLuint start, GLuint count) {
+		Scene::Drawable::Pipeline const &pipeline = caster.drawable->pipeline;
+		glBindVertexArray(pipeline.vao);
+		glm::mat4 object_to_clip = world_to_clip * glm::mat4(caster.object_to_world);
+		glUniformMatrix4fv(shadow_program->OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(object_to_clip));
+		glDrawArrays(pipeline.type, start, count);
+		Profiler::count_draw_call();
+		casters_drawn += 1;
+	};
+
+	//the dynamic casters a map sees, with their levels of detail:
+	struct Visible {
+		Caster const *caster;
+		GLuint start, count;
+	};
+	frame_vector< Visible > visible;
+
+	//bring a map (drawn in the square 'x', 'y', 'size' of its framebuffers) up to date:
+	// (the viewport -- and, for a part of a framebuffer, the scissor rectangle -- should already be set to the square)
+	auto update_map = [&](Map &map, glm::mat4 const &world_to_clip, Texel const &texel, uint32_t plane_count,
+		GLuint static_framebuffer, GLuint framebuffer, GLint x, GLint y, GLint size) {
+
+		glm::vec4 planes[6];
+		clip_planes(world_to_clip, planes);
+
+		//static casters are only redrawn if the map moved:
+		bool redraw = false;
+		if (!map.static_valid || map.world_to_clip != world_to_clip) {
+			map.world_to_clip = world_to_clip;
+			map.static_valid = true;
+			glBindFramebuffer(GL_FRAMEBUFFER, static_framebuffer);
+			glClear(GL_DEPTH_BUFFER_BIT);
+			for (Caster const &caster : static_casters) {
+				if (!inside(caster, planes, plane_count)) continue;
+				GLuint start, count;
+				pick_level(caster, texel.at(caster), &start, &count);
+				draw(caster, world_to_clip, start, count);
+			}
+			static_redraws += 1;
+			redraw = true;
+		}
+
+		//dynamic casters are only redrawn if any of them moved (or came or went):
+		visible.clear();
+		uint64_t signature = 0xcbf29ce484222325ULL;
+		for (Caster const &caster : dynamic_casters) {
+			if (!inside(caster, planes, plane_count)) continue;
+			Visible v;
+			v.caster = &caster;
+			pick_level(caster, texel.at(caster), &v.start, &v.count);
+			visible.emplace_back(v);
+			signature = hash_bytes(signature, &caster.drawable, sizeof(caster.drawable));
+			signature = hash_bytes(signature, &caster.object_to_world, sizeof(caster.object_to_world));
+			signature = hash_bytes(signature, &v.start, sizeof(v.start));
+			signature = hash_bytes(signature, &v.count, sizeof(v.count));
+		}
+		if (!redraw && signature == map.dynamic_signature) return;
+		map.dynamic_signature = signature;
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, static_framebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+		glBlitFramebuffer(x, y, x + size, y + size, x, y, x + size, y + size, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		for (Visible const &v : visible) {
+			draw(*v.caster, world_to_clip, v.start, v.count);
+		}
+		dynamic_redraws += 1;
+	};
+
+	//----- set up to draw -----
+	GLint old_framebuffer = 0;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &old_framebuffer);
+	GLint old_viewport[4];
+	glGetIntegerv(GL_VIEWPORT, old_viewport);
+	GLboolean old_depth_test = glIsEnabled(GL_DEPTH_TEST);
+
+	glUseProgram(shadow_program->program);
+	glEnable(GL_DEPTH_TEST);
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+	//(slope-scaled bias keeps surfaces from shadowing themselves)
+	glEnable(GL_POLYGON_OFFSET_FILL);
+	glPolygonOffset(2.0f, 4.0f);
+
+	//----- directional light: cascades -----
+	cascade_light = nullptr;
+	for (auto const &light : scene.lights) {
+		if (light.type == Scene::Light::Directional) {
+			cascade_light = &light;
+			break;
+		}
+	}
+	if (cascade_light) {
+		glm::mat3 world_to_light = light_axes(cascade_light->transform->make_local_to_world());
+		glm::mat4x3 camera_to_world = camera.transform->make_local_to_world();
+
+		float near = camera.near;
+		float far_ = std::max(far, 2.0f * near);
+		//(squared half-diagonal of the view per unit of depth)
+		float tan_y = std::tan(0.5f * camera.fovy);
+		float k2 = tan_y * tan_y * (1.0f + camera.aspect * camera.aspect);
+
+		//(casters between the light and a cascade still shadow it, so depth is clamped rather than clipped at the near plane)
+		glEnable(GL_DEPTH_CLAMP);
+		glViewport(0, 0, CascadeSize, CascadeSize);
+
+		float begin = near;
+		for (uint32_t c = 0; c < Cascades; ++c) {
+			float t = float(c + 1) / float(Cascades);
+			float end = split_blend * near * std::pow(far_ / near, t) + (1.0f - split_blend) * (near + (far_ - near) * t);
+			cascade_splits[c] = end;
+
+			//bounding sphere of the view between depths 'begin' and 'end':
+			// (depends only on the camera's projection, so it doesn't change as the camera moves)
+			float center = std::min(end, 0.5f * (begin + end) * (1.0f + k2));
+			float radius = std::sqrt((end - center) * (end - center) + end * end * k2);
+
+			//the map covers the sphere with room to spare, so its center can snap to a coarse grid in light space:
+			// (the map only moves -- and its static casters are only redrawn -- when the camera crosses a grid line;
+			//  grid lines are a whole number of texels apart, so shadow edges don't crawl when it does)
+			float step = radius / 3.0f;
+			float half = radius + step; //(so a texel is 'step' / (CascadeSize / 8))
+			glm::vec3 at = world_to_light * (camera_to_world * glm::vec4(0.0f, 0.0f, -center, 1.0f));
+			at = glm::floor(at / step + 0.5f) * step;
+
+			//orthographic projection along the light's -z axis:
+			glm::mat4 world_to_clip(
+				world_to_light[0][0] / half, world_to_light[0][1] / half, -world_to_light[0][2] / half, 0.0f,
+				world_to_light[1][0] / half, world_to_light[1][1] / half, -world_to_light[1][2] / half, 0.0f,
+				world_to_light[2][0] / half, world_to_light[2][1] / half, -world_to_light[2][2] / half, 0.0f,
+				-at.x / half, -at.y / half, at.z / half, 1.0f
+			);
+			cascades[c].texel = 2.0f * half / float(CascadeSize);
+
+			update_map(cascades[c], world_to_clip, Texel{ cascades[c].texel, 0.0f, glm::vec3(0.0f) }, 5,
+				cascade_static_framebuffers[c], cascade_framebuffers[c], 0, 0, CascadeSize);
+
+			begin = end;
+		}
+
+		glDisable(GL_DEPTH_CLAMP);
+	} else {
+		for (auto &split : cascade_splits) split = 0.0f;
+	}
+
+	//----- spot lights: atlas tiles -----
+	{
+		glm::vec3 eye = camera.transform->make_local_to_world()[3];
+
+		//the spot lights nearest the camera get tiles:
+		struct Candidate {
+			Scene::Light const *light;
+			float distance; //(from the camera to the light's range)
+			float range;
+		};
+		frame_vector< Candidate > candidates;
+		for (auto const &light : scene.lights) {
+			if (light.type != Scene::Light::Spot) continue;
+			float brightest = std::max(light.energy.r, std::max(light.energy.g, light.energy.b));
+			if (!(brightest > 0.0f)) continue;
+			float range = std::sqrt(brightest / cutoff);
+			float distance = std::max(0.0f, glm::length(light.transform->make_local_to_world()[3] - eye) - range);
+			if (distance > far) continue;
+			candidates.emplace_back(Candidate{ &light, distance, range });
+		}
+		if (candidates.size() > SpotSlots) {
+			std::nth_element(candidates.begin(), candidates.begin() + SpotSlots, candidates.end(), [](Candidate const &a, Candidate const &b) {
+				return a.distance < b.distance;
+			});
+			candidates.resize(SpotSlots);
+		}
+
+		//lights that are still nearest keep their tiles (and cached maps); the rest give theirs up:
+		for (uint32_t s = 0; s < SpotSlots; ++s) {
+			if (!spot_lights[s]) continue;
+			bool kept = std::any_of(candidates.begin(), candidates.end(), [&](Candidate const &c) { return c.light == spot_lights[s]; });
+			if (!kept) {
+				spot_lights[s] = nullptr;
+				spots[s] = Map();
+			}
+		}
+
+		//(the scissor rectangle keeps clears and copies inside each light's tile)
+		glEnable(GL_SCISSOR_TEST);
+		for (auto const &candidate : candidates) {
+			int32_t slot = spot_slot(candidate.light);
+			if (slot == -1) {
+				slot = spot_slot(nullptr);
+				assert(slot != -1); //(there are at most SpotSlots candidates)
+				spot_lights[slot] = candidate.light;
+			}
+
+			glm::mat4x3 light_to_world = candidate.light->transform->make_local_to_world();
+			glm::mat3 world_to_light = light_axes(light_to_world);
+			glm::vec3 position = light_to_world[3];
+			glm::mat4 world_to_view = glm::mat4(world_to_light);
+			world_to_view[3] = glm::vec4(-(world_to_light * position), 1.0f);
+
+			float fov = std::min(candidate.light->spot_fov, glm::radians(170.0f));
+			float near = std::max(0.01f * candidate.range, 0.05f);
+			glm::mat4 world_to_clip = glm::perspective(fov, 1.0f, near, candidate.range) * world_to_view;
+			spots[slot].texel = 2.0f * std::tan(0.5f * fov) / float(SpotSize);
+
+			GLint x = GLint(uint32_t(slot) % AtlasTiles * SpotSize);
+			GLint y = GLint(uint32_t(slot) / AtlasTiles * SpotSize);
+			glViewport(x, y, SpotSize, SpotSize);
+			glScissor(x, y, SpotSize, SpotSize);
+			update_map(spots[slot], world_to_clip, Texel{ 0.0f, spots[slot].texel, position }, 6,
+				spot_static_framebuffer, spot_framebuffer, x, y, SpotSize);
+		}
+		glDisable(GL_SCISSOR_TEST);
+	}
+
+	//----- restore state -----
+	glDisable(GL_POLYGON_OFFSET_FILL);
+	glPolygonOffset(0.0f, 0.0f);
+	if (!old_depth_test) glDisable(GL_DEPTH_TEST);
+	glUseProgram(0);
+	glBindVertexArray(0);
+	glBindFramebuffer(GL_FRAMEBUFFER, GLuint(old_framebuffer));
+	glViewport(old_viewport[0], old_viewport[1], old_viewport[2], old_viewport[3]);
+
+	GL_ERRORS();
+}
+
+void ShadowMaps::bind() const {
+	LitColorTextureProgram const &program = *lit_color_texture_program;
+
+	//from clip space to the [0,1] texture coordinates and depth the maps are looked up with:
+	glm::mat4 clip_to_texture(
+		0.5f, 0.0f, 0.0f, 0.0f,
+		0.0f, 0.5f, 0.0f, 0.0f,
+		0.0f, 0.0f, 0.5f, 0.0f,
+		0.5f, 0.5f, 0.5f, 1.0f
+	);
+
+	glm::mat4 cascade_to_shadow[Cascades];
+	glm::vec4 splits(0.0f), texels(0.0f);
+	for (uint32_t c = 0; c < Cascades; ++c) {
+		cascade_to_shadow[c] = clip_to_texture * cascades[c].world_to_clip;
+		splits[c] = cascade_splits[c];
+		texels[c] = cascades[c].texel;
+	}
+
+	glm::mat4 spot_to_shadow[SpotSlots];
+	float spot_texels[SpotSlots];
+	for (uint32_t s = 0; s < SpotSlots; ++s) {
+		//(squeezed into the slot's tile of the atlas)
+		glm::mat4 to_tile(1.0f);
+		to_tile[0][0] = to_tile[1][1] = 1.0f / float(AtlasTiles);
+		to_tile[3][0] = float(s % AtlasTiles) / float(AtlasTiles);
+		to_tile[3][1] = float(s / AtlasTiles) / float(AtlasTiles);
+		spot_to_shadow[s] = to_tile * clip_to_texture * spots[s].world_to_clip;
+		spot_texels[s] = spots[s].texel;
+	}
+
+	glUseProgram(program.program);
+	glUniformMatrix4fv(program.CASCADE_WORLD_TO_SHADOW_mat4_array, Cascades, GL_FALSE, glm::value_ptr(cascade_to_shadow[0]));
+	glUniform4fv(program.CASCADE_SPLITS_vec4, 1, glm::value_ptr(splits));
+	glUniform4fv(program.CASCADE_TEXEL_vec4, 1, glm::value_ptr(texels));
+	glUniformMatrix4fv(program.SPOT_WORLD_TO_SHADOW_mat4_array, SpotSlots, GL_FALSE, glm::value_ptr(spot_to_shadow[0]));
+	glUniform1fv(program.SPOT_SHADOW_TEXEL_float_array, SpotSlots, spot_texels);
+	glUseProgram(0);
+
+	glActiveTexture(GL_TEXTURE0 + LitColorTextureProgram::CascadeShadowTextureUnit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, cascade_texture);
+	glActiveTexture(GL_TEXTURE0 + LitColorTextureProgram::SpotShadowTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, spot_texture);
+	glActiveTexture(GL_TEXTURE0);
+
+	GL_ERRORS();
+}
+
+void ShadowMaps::unbind() const {
+	glActiveTexture(GL_TEXTURE0 + LitColorTextureProgram::CascadeShadowTextureUnit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	glActiveTexture(GL_TEXTURE0 + LitColorTextureProgram::SpotShadowTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+/*
+ * ShadowMaps renders shadow maps for a scene's directional and spot lights,
+ * for lit_color_texture_program to read:
+ *
+ *  - The first directional light gets cascaded shadow maps: the view out to
+ *    'far' is split into Cascades depth ranges, and each range's bounding
+ *    sphere gets its own orthographic map (layers of one depth texture array).
+ *  - Up to SpotSlots spot lights (the nearest to the camera) get a perspective
+ *    map each, in tiles of a shadow atlas. A light keeps its tile while it
+ *    stays among the nearest, so its map can be reused.
+ *  - Casters are drawn with a depth-only program (ShadowProgram), culled to
+ *    each map's volume.
+ *
+ * Maps are cached: each map's static casters (see Scene::partition) are drawn
+ * into a separate static depth texture, which is only redrawn when the map's
+ * matrix changes. The map itself is the static depth copied over, with the
+ * dynamic casters drawn on top, and is only redrawn when that static layer
+ * was redrawn or the dynamic casters it sees have moved. Cascades move in
+ * coarse snapped steps (not with every camera motion), so in a mostly static
+ * scene most frames don't draw any casters at all.
+ *
+ * Maps are looked up with "light space" positions -- world space, with
+ * Scene::draw's default world_to_light.
+ *
+ * Only use from the main (OpenGL context) thread.
+ *
+ */
+
+#include "GL.hpp"
+#include "Scene.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct ShadowMaps {
+	ShadowMaps();
+	~ShadowMaps();
+	ShadowMaps(ShadowMaps const &) = delete;
+	ShadowMaps &operator=(ShadowMaps const &) = delete;
+
+	//bring the shadow maps of 'scene''s lights up to date for drawing from 'camera':
+	// (changes the framebuffer binding and viewport -- restores both before returning)
+	void update(Scene const &scene, Scene::Camera const &camera);
+
+	//bind the shadow textures and set lit_color_texture_program's shadow uniforms (call before drawing):
+	void bind() const;
+	//unbind the shadow textures (call after drawing):
+	void unbind() const;
+
+	//forget all cached maps (e.g., after re-partitioning the scene or changing its static drawables):
+	void invalidate();
+
+	//which lights have shadows (from the last update()), for LightClusters:
+	Scene::Light const *cascade_light = nullptr; //the directional light with cascaded maps (if any)
+	int32_t spot_slot(Scene::Light const *light) const; //atlas tile of a spot light's map (or -1 if it has none)
+
+	static constexpr uint32_t Cascades = 4; //(must match the shader)
+	static constexpr uint32_t CascadeSize = 2048; //pixels across each cascade's map
+	static constexpr uint32_t SpotSize = 512; //pixels across each spot light's map...
+	static constexpr uint32_t AtlasTiles = 4; //...in an atlas this many maps across
+	static constexpr uint32_t SpotSlots = AtlasTiles * AtlasTiles; //(must match the shader)
+
+	float far = 100.0f; //cascades cover the view out to this distance from the camera
+	float split_blend = 0.75f; //cascade depth ranges are spaced exponentially (1) or evenly (0), or in between
+	float cutoff = 1.0f / 256.0f; //spot light maps reach until the light's energy drops below this (as in LightClusters)
+
+	//drawables with this program cast shadows (default: lit_color_texture_program's):
+	// (drawables' vertex arrays are used as-is, so they must be made for a program with Position at ShadowProgram's location)
+	GLuint caster_program = 0;
+
+	//statistics from the last update():
+	uint32_t static_redraws = 0; //maps whose static casters were redrawn
+	uint32_t dynamic_redraws = 0; //maps whose dynamic casters were redrawn
+	uint32_t casters_drawn = 0; //caster draw calls
+
+	//---- internals ----
+	//a drawable that might cast a shadow, with its object-to-world matrix and world-space bounding sphere:
+	struct Caster {
+		Scene::Drawable const *drawable;
+		glm::mat4x3 object_to_world;
+		glm::vec3 center;
+		float radius; //(infinite if the drawable's bounds aren't known)
+	};
+	std::vector< Caster > static_casters, dynamic_casters;
+	std::shared_ptr< Scene::StaticPart const > static_part; //static part that static_casters came from
+	// (held, so a freed part's address can't be mistaken for a new one; copies of a scene share their part -- and so this cache)
+
+	//one shadow map's cache state:
+	struct Map {
+		glm::mat4 world_to_clip = glm::mat4(0.0f); //matrix the static layer was drawn with
+		float texel = 0.0f; //size of a texel (world units, or per unit of distance for spot lights)
+		bool static_valid = false; //static layer was drawn with world_to_clip
+		uint64_t dynamic_signature = 0; //hash of the dynamic casters drawn into the map
+	};
+	Map cascades[Cascades];
+	float cascade_splits[Cascades] = { }; //view depth where each cascade ends
+
+	Map spots[SpotSlots];
+	Scene::Light const *spot_lights[SpotSlots] = { }; //light in each atlas tile (or nullptr)
+
+	//depth textures (maps, and the static layers they start from) and framebuffers that draw into them:
+	GLuint cascade_texture = 0, cascade_static_texture = 0; //GL_TEXTURE_2D_ARRAY, one layer per cascade
+	GLuint cascade_framebuffers[Cascades] = { }, cascade_static_framebuffers[Cascades] = { };
+	GLuint spot_texture = 0, spot_static_texture = 0; //GL_TEXTURE_2D atlas
+	GLuint spot_framebuffer = 0, spot_static_framebuffer = 0;
+};
@@ -0,0 +1,42 @@
+#include "ShadowProgram.hpp"
+
+#include "LitColorTextureProgram.hpp"
+#include "gl_compile_program.hpp"
+#include "gl_errors.hpp"
+
+//(LoadTagDefault, so lit_color_texture_program -- loaded early -- is ready)
+Load< ShadowProgram > shadow_program(LoadTagDefault);
+
+ShadowProgram::ShadowProgram() {
+	program = gl_compile_program(
+		//vertex shader:
+		"#version 330\n"
+		"uniform mat4 OBJECT_TO_CLIP;\n"
+		"in vec4 Position;\n"
+		"void main() {\n"
+		"	gl_Position = OBJECT_TO_CLIP * Position;\n"
+		"}\n"
+	,
+		//fragment shader:
+		// (only depth is written)
+		"#version 330\n"
+		"void main() {\n"
+		"}\n"
+	,
+		//read positions from the same attribute as lit_color_texture_program:
+		{ { "Position", lit_color_texture_program->Position_vec4 } }
+	);
+
+	//look up the locations of vertex attributes:
+	Position_vec4 = glGetAttribLocation(program, "Position");
+
+	//look up the locations of uniforms:
+	OBJECT_TO_CLIP_mat4 = glGetUniformLocation(program, "OBJECT_TO_CLIP");
+
+	GL_ERRORS();
+}
+
+ShadowProgram::~ShadowProgram() {
+	glDeleteProgram(program);
+	program = 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "GL.hpp"
+#include "Load.hpp"
+
+//Depth-only shader program that draws shadow casters into shadow maps (used by ShadowMaps):
+// its Position attribute is bound to lit_color_texture_program's location, so it can draw through the same vertex arrays.
+struct ShadowProgram {
+	ShadowProgram();
+	~ShadowProgram();
+
+	GLuint program = 0;
+	//Attribute (per-vertex variable) locations:
+	GLuint Position_vec4 = -1U;
+	//Uniform (per-invocation variable) locations:
+	GLuint OBJECT_TO_CLIP_mat4 = -1U;
+};
+
+extern Load< ShadowProgram > shadow_program;
@@ -121,7 +121,7 @@ void ShowSceneMode::draw(glm::uvec2 const &drawable_size) {
 			draw_lines.draw(xf(glm::vec3(0.0f)), xf(glm::vec3(0.0f, 0.0f, -len)), glm::u8vec4(0x00, 0x00, 0x88, 0xff));
 
 			//transform name:
-			draw_lines.draw_text("'" + transform.name + "'",
+			draw_lines.draw_text("'" + transform.name.str() + "'",
 				xf(glm::vec3(0.05f, 0.0f, 0.05f)),
 				0.15f * xfd(glm::vec3(1.0f, 0.0f, 0.0f)),
 				0.15f * xfd(glm::vec3(0.0f, 0.0f, 1.0f)),
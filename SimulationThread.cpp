@@ -0,0 +1,56 @@
+#include "SimulationThread.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+using Clock = std::chrono::steady_clock;
+
+static int64_t now_ns() {
+	return std::chrono::duration_cast< std::chrono::nanoseconds >(Clock::now().time_since_epoch()).count();
+}
+
+SimulationThread::SimulationThread(std::shared_ptr< Mode > const &mode_) : mode(mode_) {
+	assert(mode && mode->fixed_timestep > 0.0f);
+	last_step_ns = now_ns();
+	thread = std::thread(&SimulationThread::run, this);
+}
+
+SimulationThread::~SimulationThread() {
+	quit = true;
+	thread.join();
+}
+
+void SimulationThread::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size) {
+	if (!events.push(Event{evt, window_size})) {
+		std::cerr << "WARNING: simulation thread's event queue is full; dropping event." << std::endl;
+	}
+}
+
+float SimulationThread::alpha() const {
+	float since = float(now_ns() - last_step_ns.load(std::memory_order_relaxed)) * 1.0e-9f;
+	return std::max(0.0f, std::min(1.0f, since / mode->fixed_timestep));
+}
+
+void SimulationThread::run() {
+	auto step = std::chrono::duration_cast< Clock::duration >(std::chrono::duration< float >(mode->fixed_timestep));
+	Clock::time_point next = Clock::now();
+
+	while (!quit) {
+		std::this_thread::sleep_until(next);
+
+		Event event;
+		while (events.pop(&event)) {
+			mode->handle_event(event.evt, event.window_size);
+		}
+
+		mode->update(mode->fixed_timestep);
+		last_step_ns.store(now_ns(), std::memory_order_relaxed);
+
+		//if updates are taking longer than a step, drop time rather than trying to catch up forever:
+		next += step;
+		Clock::time_point now = Clock::now();
+		if (now - next > step * int(Mode::MaxStepsPerFrame)) next = now;
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+/*
+ * SimulationThread runs a Mode's handle_event and update functions on a thread of
+ * their own (at the mode's fixed_timestep), so that a slow update doesn't hold up
+ * drawing, and drawing doesn't hold up the simulation. main.cpp uses it when run
+ * with --threaded-update (for modes that set Mode::threaded_update_ok).
+ *
+ * The main thread keeps polling for events, forwarding them through a lock-free
+ * queue, and keeps calling the mode's interpolate and draw functions. See Mode.hpp
+ * for what modes must do to allow this.
+ *
+ */
+
+#include "Mode.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+//Fixed-size queue for one producer thread and one consumer thread:
+template< typename T, uint32_t Size >
+struct SPSCQueue {
+	static_assert((Size & (Size - 1)) == 0, "Size must be a power of two.");
+
+	//producer: returns false (and drops 'item') if the queue is full:
+	bool push(T const &item) {
+		uint32_t t = tail.load(std::memory_order_relaxed);
+		if (t - head.load(std::memory_order_acquire) == Size) return false;
+		items[t % Size] = item;
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	//consumer: returns false if the queue is empty:
+	bool pop(T *item) {
+		uint32_t h = head.load(std::memory_order_relaxed);
+		if (h == tail.load(std::memory_order_acquire)) return false;
+		*item = items[h % Size];
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	std::array< T, Size > items;
+	std::atomic< uint32_t > head{0}; //next item to pop (counts up forever; wraps harmlessly)
+	std::atomic< uint32_t > tail{0}; //next item to push
+};
+
+struct SimulationThread {
+	//start simulating 'mode' (which must have a fixed_timestep):
+	SimulationThread(std::shared_ptr< Mode > const &mode);
+	//stop (and wait for) the thread:
+	~SimulationThread();
+	SimulationThread(SimulationThread const &) = delete;
+	SimulationThread &operator=(SimulationThread const &) = delete;
+
+	//pass an event to the mode's handle_event (call from the main thread):
+	void handle_event(SDL_Event const &evt, glm::uvec2 const &window_size);
+
+	//fraction of a step that has passed since the most recent update finished (for Mode::interpolate):
+	float alpha() const;
+
+	std::shared_ptr< Mode > mode;
+
+	struct Event {
+		SDL_Event evt;
+		glm::uvec2 window_size;
+	};
+	SPSCQueue< Event, 256 > events;
+
+	std::atomic< bool > quit{false};
+	std::atomic< int64_t > last_step_ns{0}; //(steady_clock time when the latest update finished)
+	std::thread thread;
+
+	void run(); //(body of 'thread')
+};
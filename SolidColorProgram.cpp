@@ -0,0 +1,39 @@
+#include "SolidColorProgram.hpp"
+
+#include "gl_compile_program.hpp"
+#include "gl_errors.hpp"
+
+Load< SolidColorProgram > solid_color_program(LoadTagEarly);
+
+SolidColorProgram::SolidColorProgram() {
+	//Compile vertex and fragment shaders using the convenient 'gl_compile_program' helper function:
+	program = gl_compile_program(
+		//vertex shader:
+		"#version 330\n"
+		"uniform mat4 OBJECT_TO_CLIP;\n"
+		"in vec4 Position;\n"
+		"void main() {\n"
+		"	gl_Position = OBJECT_TO_CLIP * Position;\n"
+		"}\n"
+	,
+		//fragment shader:
+		"#version 330\n"
+		"uniform vec4 COLOR;\n"
+		"out vec4 fragColor;\n"
+		"void main() {\n"
+		"	fragColor = COLOR;\n"
+		"}\n"
+	);
+
+	//look up the locations of vertex attributes:
+	Position_vec4 = glGetAttribLocation(program, "Position");
+
+	//look up the locations of uniforms:
+	OBJECT_TO_CLIP_mat4 = glGetUniformLocation(program, "OBJECT_TO_CLIP");
+	COLOR_vec4 = glGetUniformLocation(program, "COLOR");
+}
+
+SolidColorProgram::~SolidColorProgram() {
+	glDeleteProgram(program);
+	program = 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "GL.hpp"
+#include "Load.hpp"
+
+//Shader program that draws transformed vertices in a single color (given as a uniform):
+struct SolidColorProgram {
+	SolidColorProgram();
+	~SolidColorProgram();
+
+	GLuint program = 0;
+	//Attribute (per-vertex variable) locations:
+	GLuint Position_vec4 = -1U;
+	//Uniform (per-invocation variable) locations:
+	GLuint OBJECT_TO_CLIP_mat4 = -1U;
+	GLuint COLOR_vec4 = -1U;
+	//Textures:
+	// none
+};
+
+extern Load< SolidColorProgram > solid_color_program;
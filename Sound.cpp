@@ -23,6 +23,10 @@ namespace {
 	//list of all currently playing samples:
 	std::list< std::shared_ptr< Sound::PlayingSample > > playing_samples;
 
+	//offline rendering (see init_offline):
+	bool offline = false;
+	double offline_owed = 0.0; //samples of time passed but not yet mixed
+
 }
 
 //public-facing data:
@@ -91,6 +95,24 @@ void Sound::shutdown() {
 }
 
 
+void Sound::init_offline() {
+	assert(device == 0 && "Use either Sound::init() or Sound::init_offline(), not both.");
+	offline = true;
+	offline_owed = 0.0;
+	std::cout << "Audio will be mixed offline." << std::endl;
+}
+
+void Sound::render_offline(float seconds, std::vector< float > *out) {
+	assert(offline && "Call Sound::init_offline() before Sound::render_offline().");
+	offline_owed += double(seconds) * AUDIO_RATE;
+	static std::vector< float > block(MIX_SAMPLES * 2);
+	while (offline_owed >= MIX_SAMPLES) {
+		mix_audio(nullptr, reinterpret_cast< Uint8 * >(block.data()), int(block.size() * sizeof(float)));
+		if (out) out->insert(out->end(), block.begin(), block.end());
+		offline_owed -= MIX_SAMPLES;
+	}
+}
+
 void Sound::lock() {
 	if (device) SDL_LockAudioDevice(device);
 }
@@ -93,6 +93,13 @@ void init(); //call Sound::init() from main.cpp before using any member function
 
 void shutdown(); //call Sound::shutdown() from main.cpp to gracefully(-ish) exit
 
+//To run without an audio device (e.g., in the benchmark), call init_offline() instead of init(),
+//  then call render_offline() to mix audio as (simulated) time passes:
+void init_offline();
+//mix 'seconds' worth of audio (in whole mixing blocks; leftover time carries over to the next call);
+//  if 'out' is given, the mixed (interleaved stereo) samples are appended to it:
+void render_offline(float seconds, std::vector< float > *out = nullptr);
+
 //Call 'Sound::play' to play a sample once.
 //  if you hang on to the return value, you can change the panning, volume, or stop playback early.
 std::shared_ptr< PlayingSample > play(
@@ -0,0 +1,219 @@
+#include "StaticBatch.hpp"
+
+#include "gl_errors.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+StaticBatch::StaticBatch(Scene *scene_, std::vector< Source > const &sources) {
+	assert(scene_);
+	Scene &scene = *scene_;
+	if (!scene.static_part) {
+		throw std::runtime_error("StaticBatch needs a partitioned scene (call Scene::partition first).");
+	}
+	//(held, since the swap below replaces the scene's static part)
+	std::shared_ptr< Scene::StaticPart const > part = scene.static_part;
+
+	//----- group static drawables by (source, program, vao, textures) -----
+	struct Group {
+		Source const *source;
+		Scene::Drawable::Pipeline const *pipeline; //(of the first member; the others match it)
+		std::vector< uint32_t > members; //indices into part->drawables
+	};
+	std::vector< Group > groups;
+
+	auto same_material = [](Scene::Drawable::Pipeline const &a, Scene::Drawable::Pipeline const &b) {
+		if (a.program != b.program || a.vao != b.vao) return false;
+		for (uint32_t i = 0; i < Scene::Drawable::Pipeline::TextureCount; ++i) {
+			if (a.textures[i].texture != b.textures[i].texture || a.textures[i].target != b.textures[i].target) return false;
+		}
+		return true;
+	};
+
+	for (uint32_t d = 0; d < uint32_t(part->drawables.size()); ++d) {
+		Scene::Drawable::Pipeline const &pipeline = part->drawables[d].pipeline;
+		if (pipeline.program == 0 || pipeline.count == 0) continue;
+		if (pipeline.type != GL_TRIANGLES) continue; //(strips and fans can't be concatenated)
+		if (pipeline.set_uniforms) continue; //(can't tell if two functions set the same uniforms)
+
+		auto source = std::find_if(sources.begin(), sources.end(), [&](Source const &s) { return s.vao == pipeline.vao; });
+		if (source == sources.end()) continue;
+
+		//(linear search is fine: scenes have few distinct materials)
+		auto group = std::find_if(groups.begin(), groups.end(), [&](Group const &g) { return same_material(*g.pipeline, pipeline); });
+		if (group == groups.end()) {
+			groups.emplace_back(Group{ &*source, &pipeline, {} });
+			group = groups.end() - 1;
+		}
+		group->members.emplace_back(d);
+	}
+
+	//(merging a single drawable doesn't save any draw calls)
+	groups.erase(std::remove_if(groups.begin(), groups.end(), [](Group const &g) { return g.members.size() < 2; }), groups.end());
+	if (groups.empty()) return;
+
+	//----- build merged vertex data, one MeshBuffer per source buffer -----
+	//the drawables replacing each group:
+	struct Batch {
+		Scene::Drawable::Pipeline pipeline;
+		MeshBuffer const *merged;
+		glm::vec3 min, max; //(world-space bounds)
+	};
+	std::vector< Batch > new_batches;
+
+	std::vector< MeshBuffer const * > done; //source buffers already merged
+	for (auto const &first : groups) {
+		MeshBuffer const &source = *first.source->buffer;
+		if (std::find(done.begin(), done.end(), &source) != done.end()) continue;
+		done.emplace_back(&source);
+
+		//check that positions (and normals) are something we can transform:
+		if (source.Position.size != 3 || source.Position.type != GL_FLOAT) {
+			throw std::runtime_error("StaticBatch needs vertex positions to be three floats.");
+		}
+		bool has_normals = (source.Normal.size != 0);
+		if (has_normals && (source.Normal.size != 3 || source.Normal.type != GL_FLOAT)) {
+			throw std::runtime_error("StaticBatch needs vertex normals to be three floats.");
+		}
+		size_t stride = size_t(source.Position.stride);
+		assert(stride > 0);
+
+		//read back the source vertices:
+		std::vector< char > data;
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, source.buffer);
+			GLint size = 0;
+			glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
+			data.resize(size_t(size));
+			glGetBufferSubData(GL_ARRAY_BUFFER, 0, data.size(), data.data());
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+		size_t source_vertices = data.size() / stride;
+
+		auto &buffer = *merged.emplace_back(std::make_unique< MeshBuffer >());
+		buffer.Position = source.Position;
+		buffer.Normal = source.Normal;
+		buffer.Color = source.Color;
+		buffer.TexCoord = source.TexCoord;
+
+		std::vector< char > out;
+		for (auto const &group : groups) {
+			if (group.source->buffer != &source) continue;
+
+			Mesh mesh;
+			mesh.type = GL_TRIANGLES;
+			mesh.start = GLuint(out.size() / stride);
+
+			for (uint32_t d : group.members) {
+				Scene::Drawable::Pipeline const &pipeline = part->drawables[d].pipeline;
+				if (size_t(pipeline.start) + size_t(pipeline.count) > source_vertices) {
+					throw std::runtime_error("StaticBatch: drawable's vertex range is outside its source buffer.");
+				}
+				glm::mat4x3 const &object_to_world = part->object_to_world[d];
+				glm::mat3 normal_to_world = glm::inverse(glm::transpose(glm::mat3(object_to_world)));
+
+				size_t begin = out.size();
+				out.insert(out.end(), data.begin() + pipeline.start * stride, data.begin() + (pipeline.start + pipeline.count) * stride);
+				for (size_t v = begin; v < out.size(); v += stride) {
+					//(memcpy, since attributes in the vertex data needn't be aligned)
+					glm::vec3 position;
+					std::memcpy(&position, &out[v + source.Position.offset], sizeof(position));
+					position = object_to_world * glm::vec4(position, 1.0f);
+					std::memcpy(&out[v + source.Position.offset], &position, sizeof(position));
+					mesh.min = glm::min(mesh.min, position);
+					mesh.max = glm::max(mesh.max, position);
+
+					if (has_normals) {
+						glm::vec3 normal;
+						std::memcpy(&normal, &out[v + source.Normal.offset], sizeof(normal));
+						normal = normal_to_world * normal;
+						float length = glm::length(normal);
+						if (length > 0.0f) normal /= length;
+						std::memcpy(&out[v + source.Normal.offset], &normal, sizeof(normal));
+					}
+				}
+			}
+
+			mesh.count = GLuint(out.size() / stride) - mesh.start;
+			buffer.meshes.emplace("batch" + std::to_string(batches), mesh);
+
+			Batch batch;
+			batch.pipeline = *group.pipeline;
+			batch.pipeline.start = mesh.start;
+			batch.pipeline.count = mesh.count;
+			batch.merged = &buffer;
+			batch.min = mesh.min;
+			batch.max = mesh.max;
+			new_batches.emplace_back(batch);
+
+			batches += 1;
+			batched += uint32_t(group.members.size());
+		}
+
+		buffer.upload(out.data(), out.size());
+	}
+
+	//----- point the new drawables at vaos for the merged buffers -----
+	struct VaoFor {
+		MeshBuffer const *merged;
+		GLuint program;
+		GLuint vao;
+	};
+	std::vector< VaoFor > made;
+	for (auto &batch : new_batches) {
+		auto f = std::find_if(made.begin(), made.end(), [&](VaoFor const &m) { return m.merged == batch.merged && m.program == batch.pipeline.program; });
+		if (f == made.end()) {
+			made.emplace_back(VaoFor{ batch.merged, batch.pipeline.program, batch.merged->make_vao_for_program(batch.pipeline.program) });
+			vaos.emplace_back(made.back().vao);
+			f = made.end() - 1;
+		}
+		batch.pipeline.vao = f->vao;
+	}
+
+	//----- swap the batched drawables for the new ones -----
+	// (the static part can't be edited, so thaw it back into the scene, edit that, and bake a new one)
+	std::vector< bool > removed(part->drawables.size(), false);
+	for (auto const &group : groups) {
+		for (uint32_t d : group.members) {
+			removed[d] = true;
+		}
+	}
+	scene.thaw(); //(appends the static drawables, in order, to scene.drawables)
+	auto drawable = std::prev(scene.drawables.end(), ptrdiff_t(part->drawables.size()));
+	for (uint32_t d = 0; d < uint32_t(part->drawables.size()); ++d) {
+		if (removed[d]) drawable = scene.drawables.erase(drawable);
+		else ++drawable;
+	}
+
+	//batched vertices are already in world space, so the new drawables hang off an identity transform:
+	static Scene::Name const StaticBatchName("StaticBatch");
+	scene.transforms.emplace_back();
+	Scene::Transform *transform = &scene.transforms.back();
+	transform->name = StaticBatchName;
+	transform->is_static = true;
+	for (auto const &batch : new_batches) {
+		scene.drawables.emplace_back(transform);
+		scene.drawables.back().pipeline = batch.pipeline;
+		scene.drawables.back().bounds_center = 0.5f * (batch.min + batch.max);
+		scene.drawables.back().bounds_radius = 0.5f * glm::length(batch.max - batch.min);
+	}
+
+	scene.bake_static(); //(also re-indexes names)
+
+	GL_ERRORS();
+}
+
+StaticBatch::~StaticBatch() {
+	glDeleteVertexArrays(GLsizei(vaos.size()), vaos.data());
+	vaos.clear();
+	for (auto &buffer : merged) {
+		glDeleteBuffers(1, &buffer->buffer);
+		buffer->buffer = 0;
+	}
+	merged.clear();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+/*
+ * StaticBatch merges a scene's static drawables (see Scene::partition) into a
+ * few big draws:
+ *
+ *  - static drawables that read the same vertex buffer with the same program,
+ *    textures, and vertex array object are grouped together;
+ *  - each group's vertices are transformed into world space and copied, one
+ *    after another, into a merged MeshBuffer, so the group is one vertex range;
+ *  - the group's drawables are removed from the scene and replaced by a single
+ *    drawable (on an identity transform named "StaticBatch") that draws the range.
+ *
+ * So a level made of thousands of static props draws in as many calls as it
+ * has distinct materials.
+ *
+ * Only GL_TRIANGLES drawables without a set_uniforms function are batched (other
+ * drawables can't be concatenated or compared), and groups of one are left alone.
+ * Drawables with levels of detail are batched at full detail (level 0): a batch
+ * is one draw, so it can't choose levels per object.
+ *
+ * Batching is done at load time, on the main (OpenGL context) thread: source
+ * vertices are read back from their MeshBuffer with glGetBufferSubData.
+ *
+ */
+
+#include "Scene.hpp"
+#include "Mesh.hpp"
+
+#include <memory>
+#include <vector>
+
+struct StaticBatch {
+	//A vertex buffer that drawables may read, and the vertex array object they read it with:
+	struct Source {
+		MeshBuffer const *buffer;
+		GLuint vao;
+	};
+
+	//batch static drawables in 'scene' (which must be partitioned) that use one of 'sources':
+	// note: throws if 'scene' isn't partitioned, or if a source's vertex format can't be transformed.
+	StaticBatch(Scene *scene, std::vector< Source > const &sources);
+	~StaticBatch();
+	StaticBatch(StaticBatch const &) = delete;
+	StaticBatch &operator=(StaticBatch const &) = delete;
+
+	//merged vertex data (one buffer per source buffer that had something to batch), and vertex array objects for it:
+	// (scene drawables -- in the batched scene and in any copies of it -- reference these, so keep the batch around while drawing)
+	std::vector< std::unique_ptr< MeshBuffer > > merged;
+	std::vector< GLuint > vaos;
+
+	uint32_t batched = 0; //drawables that were merged...
+	uint32_t batches = 0; //...into this many
+};
@@ -0,0 +1,89 @@
+#include "StreamBuffer.hpp"
+
+#include "gl_errors.hpp"
+
+#include <cassert>
+#include <cstring>
+
+StreamBuffer &immediate_stream() {
+	static StreamBuffer *stream = new StreamBuffer();
+	return *stream;
+}
+
+static GLsizeiptr round_up(GLsizeiptr value, GLsizeiptr multiple) {
+	return (value + multiple - 1) / multiple * multiple;
+}
+
+StreamBuffer::StreamBuffer(GLsizeiptr segment_size_) {
+	glGenBuffers(1, &buffer);
+	grow(segment_size_);
+	GL_ERRORS();
+}
+
+StreamBuffer::~StreamBuffer() {
+	for (auto &fence : fences) {
+		if (fence) glDeleteSync(fence);
+		fence = 0;
+	}
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+}
+
+void StreamBuffer::advance() {
+	if (fences[segment]) glDeleteSync(fences[segment]);
+	fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	segment = (segment + 1) % Segments;
+	used = 0;
+
+	//wait until the GPU is done reading from the next segment:
+	if (fences[segment]) {
+		while (glClientWaitSync(fences[segment], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ULL /* 1s */) == GL_TIMEOUT_EXPIRED) { }
+		glDeleteSync(fences[segment]);
+		fences[segment] = 0;
+	}
+}
+
+void StreamBuffer::grow(GLsizeiptr min_segment_size) {
+	//(old storage is orphaned, so the GPU can finish with it in its own time)
+	for (auto &fence : fences) {
+		if (fence) glDeleteSync(fence);
+		fence = 0;
+	}
+	segment_size = round_up(min_segment_size, 256);
+	segment = 0;
+	used = 0;
+
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, segment_size * Segments, nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+GLintptr StreamBuffer::write(void const *data, GLsizeiptr size, GLsizeiptr alignment) {
+	assert(alignment > 0 && 256 % alignment == 0);
+
+	GLsizeiptr at = round_up(used, alignment);
+	if (at + size > segment_size) {
+		if (size > segment_size) {
+			grow(round_up(size, segment_size) * 2);
+		} else {
+			advance();
+		}
+		at = 0;
+	}
+	GLintptr offset = GLintptr(segment) * segment_size + at;
+
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	void *dst = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (dst) {
+		std::memcpy(dst, data, size);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	} else {
+		//(mapping shouldn't fail, but fall back to a plain upload if it does)
+		glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	used = at + size;
+	return offset;
+}
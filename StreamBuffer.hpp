@@ -0,0 +1,53 @@
+#pragma once
+
+/*
+ * StreamBuffer is a vertex buffer for data that changes every frame (e.g., DrawLines).
+ *
+ * Rather than re-allocating buffer storage on every upload (glBufferData), it is
+ * split into three segments that are filled in turn, ring-buffer style. When
+ * a segment fills up, a fence is placed after the draws that read from it, and
+ * writing moves on to the next segment (waiting, if needed, for the GPU to finish
+ * with it). Data is written with unsynchronized glMapBufferRange calls, so the
+ * driver never has to stall or make copies to keep data it's still using intact.
+ *
+ * (Persistently-mapped buffers would save the map/unmap calls, but require GL 4.4.)
+ *
+ * write() returns the byte offset of the data in the buffer; use it as an offset
+ * for glVertexAttribPointer or (divided by the vertex size) as a first vertex.
+ *
+ */
+
+#include "GL.hpp"
+
+#include <array>
+#include <cstdint>
+
+struct StreamBuffer {
+	//(segment_size is rounded up to a multiple of 256 bytes)
+	StreamBuffer(GLsizeiptr segment_size = 1 << 18);
+	~StreamBuffer();
+	StreamBuffer(StreamBuffer const &) = delete;
+	StreamBuffer &operator=(StreamBuffer const &) = delete;
+
+	//Copy 'size' bytes from 'data' into the buffer; returns the offset they were written at (a multiple of 'alignment'):
+	// (alignment must divide 256)
+	// NOTE: leaves GL_ARRAY_BUFFER unbound
+	GLintptr write(void const *data, GLsizeiptr size, GLsizeiptr alignment = 16);
+
+	GLuint buffer = 0; //name never changes, so it's fine to reference from vertex array objects
+
+	static constexpr uint32_t Segments = 3;
+	GLsizeiptr segment_size = 0;
+	uint32_t segment = 0; //segment currently being written
+	GLsizeiptr used = 0; //bytes used in current segment
+	std::array< GLsync, Segments > fences{}; //fence after last use of each segment (if any)
+
+	//fence the current segment and move to the next one:
+	void advance();
+	//re-allocate storage so that segments hold at least 'min_segment_size' bytes:
+	void grow(GLsizeiptr min_segment_size);
+};
+
+//Shared by immediate-mode drawing helpers (DrawLines, ...):
+// (created on first use, so only call once there is an OpenGL context; never freed)
+StreamBuffer &immediate_stream();
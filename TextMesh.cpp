@@ -0,0 +1,81 @@
+#include "TextMesh.hpp"
+#include "PathFont.hpp"
+#include "SolidColorProgram.hpp"
+#include "Profiler.hpp"
+#include "FrameArena.hpp"
+
+#include "gl_errors.hpp"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <vector>
+
+TextMesh::TextMesh() {
+	glGenBuffers(1, &vertex_buffer);
+
+	{ //vertex array mapping buffer for solid_color_program:
+		glGenVertexArrays(1, &vertex_array);
+		glBindVertexArray(vertex_array);
+		glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+
+		glVertexAttribPointer(
+			solid_color_program->Position_vec4, //attribute
+			2, //size
+			GL_FLOAT, //type
+			GL_FALSE, //normalized
+			sizeof(glm::vec2), //stride
+			(GLbyte *)0 //offset
+		);
+		glEnableVertexAttribArray(solid_color_program->Position_vec4);
+		//[vec2 -> vec4 attribute is fine; z is filled with 0.0 and w with 1.0]
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindVertexArray(0);
+	}
+
+	GL_ERRORS();
+}
+
+TextMesh::~TextMesh() {
+	glDeleteVertexArrays(1, &vertex_array);
+	vertex_array = 0;
+	glDeleteBuffers(1, &vertex_buffer);
+	vertex_buffer = 0;
+}
+
+void TextMesh::set(std::string const &text_, glm::vec2 const &x_, glm::vec2 const &y_) {
+	if (built && text_ == text && x_ == x && y_ == y) return; //nothing changed
+
+	text = text_;
+	x = x_;
+	y = y_;
+
+	frame_vector< glm::vec2 > lines;
+	width = PathFont::font.layout(text, &lines);
+	for (auto &pt : lines) {
+		pt = pt.x * x + pt.y * y;
+	}
+	width *= glm::length(x);
+
+	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+	glBufferData(GL_ARRAY_BUFFER, lines.size() * sizeof(lines[0]), lines.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	count = GLsizei(lines.size());
+	built = true;
+}
+
+void TextMesh::draw(glm::mat4 const &object_to_clip, glm::vec4 const &color) const {
+	if (count == 0) return;
+
+	glUseProgram(solid_color_program->program);
+	glUniformMatrix4fv(solid_color_program->OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(object_to_clip));
+	glUniform4fv(solid_color_program->COLOR_vec4, 1, glm::value_ptr(color));
+
+	glBindVertexArray(vertex_array);
+	glDrawArrays(GL_LINES, 0, count);
+	Profiler::count_draw_call();
+	glBindVertexArray(0);
+
+	glUseProgram(0);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+/*
+ * TextMesh holds PathFont text (see PathFont.hpp) as line segments in its own
+ * vertex buffer, so strings that rarely change (HUD counters, labels, ...) don't
+ * need to be laid out again every frame the way DrawLines::draw_text does.
+ *
+ * set() only rebuilds the buffer when the text or style actually changed;
+ * draw() is a single draw call with the transform and color as uniforms.
+ *
+ * Text is laid out with its baseline starting at the origin, one unit high, in the x/y plane.
+ *
+ */
+
+#include "GL.hpp"
+
+#include <glm/glm.hpp>
+
+#include <string>
+
+struct TextMesh {
+	//(needs an OpenGL context)
+	TextMesh();
+	~TextMesh();
+	TextMesh(TextMesh const &) = delete;
+	TextMesh &operator=(TextMesh const &) = delete;
+
+	//Change text and/or style:
+	// 'x' and 'y' are the directions characters advance and rise (e.g., use a slanted 'y' for italics)
+	void set(std::string const &text, glm::vec2 const &x = glm::vec2(1.0f, 0.0f), glm::vec2 const &y = glm::vec2(0.0f, 1.0f));
+
+	//Draw as lines:
+	void draw(glm::mat4 const &object_to_clip, glm::vec4 const &color) const;
+
+	//current contents:
+	std::string text;
+	glm::vec2 x = glm::vec2(1.0f, 0.0f);
+	glm::vec2 y = glm::vec2(0.0f, 1.0f);
+	float width = 0.0f; //advance of the whole string along 'x'
+
+	GLuint vertex_buffer = 0;
+	GLuint vertex_array = 0; //for solid_color_program
+	GLsizei count = 0; //vertices in buffer
+	bool built = false; //has buffer been filled?
+};
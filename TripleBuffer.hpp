@@ -0,0 +1,50 @@
+#pragma once
+
+/*
+ * TripleBuffer hands the most recent version of a value from one thread (the
+ * writer) to another (the reader) without locks or waiting:
+ *
+ *  - the writer fills in write_buffer() and then calls publish();
+ *  - the reader calls update() to pick up the newest published value (if there
+ *    is one it hasn't seen), then reads read_buffer().
+ *
+ * The writer and reader each own one of the three buffers; the third is
+ * exchanged through a single atomic. Values that are published faster than the
+ * reader picks them up are skipped (it only ever sees the latest).
+ *
+ * Buffers are re-used, so (e.g.) vectors in T don't re-allocate once warmed up.
+ *
+ */
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+template< typename T >
+struct TripleBuffer {
+	//writer: value to fill in before publishing:
+	T &write_buffer() { return buffers[write_index]; }
+
+	//writer: make write_buffer() the newest value (and get a new write_buffer()):
+	void publish() {
+		uint8_t old = shared.exchange(uint8_t(write_index | Fresh), std::memory_order_acq_rel);
+		write_index = old & Index;
+	}
+
+	//reader: switch to the newest published value; returns false if there wasn't a new one:
+	bool update() {
+		if (!(shared.load(std::memory_order_relaxed) & Fresh)) return false;
+		uint8_t old = shared.exchange(read_index, std::memory_order_acq_rel);
+		read_index = old & Index;
+		return true;
+	}
+
+	//reader: most recent value picked up by update():
+	T const &read_buffer() const { return buffers[read_index]; }
+
+	std::array< T, 3 > buffers;
+	uint8_t write_index = 0; //(only used by the writer)
+	uint8_t read_index = 1; //(only used by the reader)
+	enum : uint8_t { Index = 0x3, Fresh = 0x4 };
+	std::atomic< uint8_t > shared{2}; //index of the exchanged buffer, plus 'Fresh' if it was published since the reader last took it
+};
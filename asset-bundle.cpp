@@ -0,0 +1,146 @@
+//asset-bundle: command-line tool for packing, listing, and extracting asset bundles (see Bundle.hpp).
+
+#include "Bundle.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static int usage(char const *exe) {
+	std::cerr << "Usage:\n"
+		"\t" << exe << " pack <out.bundle> <dir> <file> [file ...]\n"
+		"\t\tPack files (named relative to <dir>) into a bundle.\n"
+		"\t" << exe << " list <in.bundle>\n"
+		"\t\tList the files in a bundle.\n"
+		"\t" << exe << " extract <in.bundle> <dir> [file ...]\n"
+		"\t\tExtract files (default: all files) from a bundle into <dir>.\n";
+	return 1;
+}
+
+static int pack(std::string const &outfile, std::string const &dir, std::vector< std::string > names) {
+	std::sort(names.begin(), names.end());
+	for (uint32_t i = 1; i < names.size(); ++i) {
+		if (names[i-1] == names[i]) {
+			std::cerr << "File '" << names[i] << "' listed twice." << std::endl;
+			return 1;
+		}
+	}
+
+	//build index (data offsets are filled in as files are read):
+	Bundle::Header header;
+	header.count = uint32_t(names.size());
+	std::string all_names;
+	std::vector< Bundle::IndexEntry > index(names.size());
+	for (uint32_t i = 0; i < names.size(); ++i) {
+		index[i].name_begin = uint32_t(all_names.size());
+		all_names += names[i];
+		index[i].name_end = uint32_t(all_names.size());
+	}
+	header.names_size = uint32_t(all_names.size());
+
+	auto align = [](uint64_t offset) {
+		return (offset + Bundle::PageSize - 1) / Bundle::PageSize * Bundle::PageSize;
+	};
+
+	std::ofstream out(outfile, std::ios::binary);
+	if (!out) {
+		std::cerr << "Failed to open '" << outfile << "' for writing." << std::endl;
+		return 1;
+	}
+
+	//reserve space for header + index, then write file data:
+	uint64_t offset = align(sizeof(Bundle::Header) + index.size() * sizeof(Bundle::IndexEntry) + all_names.size());
+	uint64_t end = offset;
+	for (uint32_t i = 0; i < names.size(); ++i) {
+		std::ifstream in(dir + "/" + names[i], std::ios::binary);
+		if (!in) {
+			std::cerr << "Failed to open '" << dir << "/" << names[i] << "'." << std::endl;
+			return 1;
+		}
+		std::vector< char > data((std::istreambuf_iterator< char >(in)), std::istreambuf_iterator< char >());
+		index[i].offset = offset;
+		index[i].size = data.size();
+		out.seekp(offset);
+		out.write(data.data(), data.size());
+		end = offset + data.size();
+		offset = align(end);
+	}
+
+	out.seekp(0);
+	out.write(reinterpret_cast< char const * >(&header), sizeof(header));
+	out.write(reinterpret_cast< char const * >(index.data()), index.size() * sizeof(Bundle::IndexEntry));
+	out.write(all_names.data(), all_names.size());
+	out.close();
+	if (!out) {
+		std::cerr << "Failed to write '" << outfile << "'." << std::endl;
+		return 1;
+	}
+
+	//check by reading back:
+	Bundle check(outfile);
+	if (check.files.size() != names.size()) throw std::runtime_error("Bundle doesn't read back correctly.");
+
+	std::cout << "Packed " << names.size() << " files into '" << outfile << "' (" << end << " bytes)." << std::endl;
+	return 0;
+}
+
+static int list(std::string const &infile) {
+	Bundle bundle(infile);
+	for (auto const &file : bundle.files) {
+		std::cout << file.size << "\t" << file.name << "\n";
+	}
+	std::cout.flush();
+	return 0;
+}
+
+static int extract(std::string const &infile, std::string const &dir, std::vector< std::string > const &names) {
+	Bundle bundle(infile);
+	std::vector< Bundle::File const * > to_extract;
+	if (names.empty()) {
+		for (auto const &file : bundle.files) to_extract.emplace_back(&file);
+	} else {
+		for (auto const &name : names) {
+			Bundle::File const *file = bundle.find(name);
+			if (!file) {
+				std::cerr << "File '" << name << "' is not in '" << infile << "'." << std::endl;
+				return 1;
+			}
+			to_extract.emplace_back(file);
+		}
+	}
+	for (auto file : to_extract) {
+		//(note: doesn't create subdirectories; extract into a directory that already has them)
+		std::ofstream out(dir + "/" + file->name, std::ios::binary);
+		out.write(file->data, file->size);
+		if (!out) {
+			std::cerr << "Failed to write '" << dir << "/" << file->name << "'." << std::endl;
+			return 1;
+		}
+		std::cout << "Extracted '" << file->name << "' (" << file->size << " bytes)." << std::endl;
+	}
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	if (argc < 2) return usage(argv[0]);
+	std::string command = argv[1];
+	std::vector< std::string > args(argv + 2, argv + argc);
+
+	try {
+		if (command == "pack" && args.size() >= 3) {
+			return pack(args[0], args[1], std::vector< std::string >(args.begin() + 2, args.end()));
+		} else if (command == "list" && args.size() == 1) {
+			return list(args[0]);
+		} else if (command == "extract" && args.size() >= 2) {
+			return extract(args[0], args[1], std::vector< std::string >(args.begin() + 2, args.end()));
+		} else {
+			return usage(argv[0]);
+		}
+	} catch (std::exception &e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,289 @@
+//Runs a Mode without a window or a human, for repeatable performance numbers:
+//  benchmark [--mode play] [--frames N] [--warmup N] [--dt seconds] [--size WxH] [--script input.txt] [--seed N] [--csv frames.csv] [--window]
+// - renders offscreen (SDL's "offscreen" video driver, which uses EGL pbuffers), or in a hidden window with --window;
+//   set LIBGL_ALWAYS_SOFTWARE=1 to use Mesa's llvmpipe on machines without a GPU
+// - delivers events from an input script (see InputScript.hpp; recordings from 'game --record' work too) on the frames it specifies
+// - seeds the mode with --seed, or else the script's seed, or else 0 (so runs are repeatable)
+// - advances time by exactly 'dt' every frame, mixing sound offline instead of playing it
+// - reports percentiles of update and draw times, and draw calls and heap allocations per frame
+//e.g.: dist/benchmark --script benchmark-swim.txt
+
+#include "Mode.hpp"
+#include "PlayMode.hpp"
+
+#include "InputScript.hpp"
+#include "FrameArena.hpp"
+#include "Jobs.hpp"
+#include "Load.hpp"
+#include "Profiler.hpp"
+#include "Sound.hpp"
+#include "data_path.hpp"
+#include "GL.hpp"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//modes that can be benchmarked:
+static std::map< std::string, std::function< std::shared_ptr< Mode >(uint32_t seed) > > const modes{
+	{"play", [](uint32_t seed){ return std::make_shared< PlayMode >(seed); }},
+	{"bubbles", [](uint32_t seed){ return std::make_shared< PlayMode >(seed, 100000); }}, //particle stress test
+	{"bubbles-gpu", [](uint32_t seed){ return std::make_shared< PlayMode >(seed, 100000, ParticleBackend::GPU); }}, //...simulated with transform feedback
+	{"lights", [](uint32_t seed){ return std::make_shared< PlayMode >(seed, PlayMode::DefaultBubbles, ParticleBackend::CPU, 500); }}, //clustered lighting (and shadow) stress test
+};
+
+int main(int argc, char **argv) {
+#ifdef _WIN32
+	//when compiled on windows, unhandled exceptions don't have their message printed, which can make debugging simple issues difficult.
+	try {
+#endif
+
+	//------------ options ------------
+	std::string mode_name = "play";
+	uint32_t frames = 1000;
+	uint32_t warmup = 60;
+	float dt = 1.0f / 60.0f;
+	glm::uvec2 size = glm::uvec2(1280, 720);
+	std::string script_file;
+	std::string seed_option;
+	std::string csv_file;
+	bool use_window = false;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		auto value = [&]() -> std::string {
+			if (i + 1 >= argc) throw std::runtime_error("Expecting a value after '" + arg + "'.");
+			i += 1;
+			return argv[i];
+		};
+		if (arg == "--mode") mode_name = value();
+		else if (arg == "--frames") frames = uint32_t(std::stoul(value()));
+		else if (arg == "--warmup") warmup = uint32_t(std::stoul(value()));
+		else if (arg == "--dt") dt = std::stof(value());
+		else if (arg == "--size") {
+			std::string wh = value();
+			size_t x = wh.find('x');
+			if (x == std::string::npos) throw std::runtime_error("Expecting --size WxH, got '" + wh + "'.");
+			size = glm::uvec2(std::stoul(wh.substr(0, x)), std::stoul(wh.substr(x + 1)));
+		}
+		else if (arg == "--script") script_file = value();
+		else if (arg == "--seed") seed_option = value();
+		else if (arg == "--csv") csv_file = value();
+		else if (arg == "--window") use_window = true;
+		else {
+			std::cerr << "Usage:\n\t" << argv[0] << " [--mode name] [--frames N] [--warmup N] [--dt seconds] [--size WxH] [--script input.txt] [--seed N] [--csv frames.csv] [--window]\n";
+			std::cerr << "Modes:";
+			for (auto const &m : modes) std::cerr << " " << m.first;
+			std::cerr << std::endl;
+			return 1;
+		}
+	}
+	if (!modes.count(mode_name)) {
+		std::cerr << "Unknown mode '" << mode_name << "'." << std::endl;
+		return 1;
+	}
+
+	InputScript script;
+	if (!script_file.empty()) script = InputScript(script_file);
+	uint32_t seed = 0;
+	if (!seed_option.empty()) seed = uint32_t(std::stoul(seed_option));
+	else if (script.has_seed) seed = script.seed;
+
+	//------------  initialization ------------
+
+	//Render offscreen, unless asked to show a window (or offscreen rendering isn't available):
+	if (!use_window) SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+	if (SDL_Init(SDL_INIT_VIDEO) != 0 && !use_window) {
+		std::cerr << "NOTE: offscreen rendering isn't available (" << SDL_GetError() << "); using a hidden window instead." << std::endl;
+		SDL_SetHint(SDL_HINT_VIDEODRIVER, "");
+		use_window = true;
+		SDL_Init(SDL_INIT_VIDEO);
+	}
+
+	//Ask for the same OpenGL context as main.cpp:
+	SDL_GL_ResetAttributes();
+	SDL_GL_SetAttribute(SDL_GL_RED_SIZE, 8);
+	SDL_GL_SetAttribute(SDL_GL_GREEN_SIZE, 8);
+	SDL_GL_SetAttribute(SDL_GL_BLUE_SIZE, 8);
+	SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, 8);
+	SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
+	SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);
+	SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+
+	SDL_Window *window = SDL_CreateWindow(
+		"benchmark",
+		SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+		int(size.x), int(size.y),
+		SDL_WINDOW_OPENGL | (use_window ? SDL_WINDOW_HIDDEN : 0)
+	);
+	if (!window) {
+		std::cerr << "Error creating SDL window: " << SDL_GetError() << std::endl;
+		return 1;
+	}
+
+	SDL_GLContext context = SDL_GL_CreateContext(window);
+	if (!context) {
+		SDL_DestroyWindow(window);
+		std::cerr << "Error creating OpenGL context: " << SDL_GetError() << std::endl;
+		return 1;
+	}
+
+	init_GL();
+
+	//don't wait for vsync (there's nothing to show, and it would hide the actual cost of frames):
+	SDL_GL_SetSwapInterval(0);
+
+	std::cout << "Rendering with " << reinterpret_cast< char const * >(glGetString(GL_RENDERER))
+		<< (use_window ? " (hidden window)" : " (offscreen)") << "." << std::endl;
+
+	Sound::init_offline();
+	Jobs::init();
+
+	{ //read assets from the bundle, if there is one (as in main.cpp):
+		std::string bundle = data_path("assets.bundle");
+		if (std::ifstream(bundle)) mount_bundle(bundle);
+	}
+	call_load_functions();
+
+	Mode::set_current(modes.at(mode_name)(seed));
+
+	glm::uvec2 window_size = size;
+	glm::uvec2 drawable_size;
+	{
+		int w, h;
+		SDL_GL_GetDrawableSize(window, &w, &h);
+		drawable_size = glm::uvec2(w, h);
+	}
+	glViewport(0, 0, drawable_size.x, drawable_size.y);
+
+	//------------ run frames ------------
+	struct FrameStats {
+		double update_ms;
+		double draw_ms; //time to issue draw calls
+		double finish_ms; //time until the GPU finished them (glFinish)
+		uint64_t draw_calls;
+		uint64_t heap_allocations;
+	};
+	std::vector< FrameStats > stats;
+	stats.reserve(frames);
+
+	using Clock = std::chrono::high_resolution_clock;
+	auto ms = [](Clock::time_point const &a, Clock::time_point const &b) {
+		return std::chrono::duration< double, std::milli >(b - a).count();
+	};
+
+	InputScript::Player player(script);
+	uint32_t frame = 0;
+	for (; frame < warmup + frames && Mode::current; ++frame) {
+		uint64_t draw_calls_before = Profiler::draw_calls;
+		uint64_t heap_before = FrameArena::heap_allocations();
+
+		SDL_Event evt;
+		while (player.next(Mode::updates, &evt)) {
+			if (evt.type == SDL_QUIT) {
+				Mode::set_current(nullptr);
+				break;
+			}
+			Mode::current->handle_event(evt, window_size);
+		}
+		if (!Mode::current) break;
+		while (SDL_PollEvent(&evt) == 1) { } //(nothing to handle, but keep the event queue from filling up)
+
+		auto before_update = Clock::now();
+		Jobs::run_main_jobs();
+		Mode::update_current(dt);
+		if (!Mode::current) break;
+		auto before_draw = Clock::now();
+		Mode::current->draw(drawable_size);
+		auto before_finish = Clock::now();
+		glFinish();
+		auto after_finish = Clock::now();
+
+		Sound::render_offline(dt);
+		FrameArena::reset();
+
+		if (frame >= warmup) {
+			stats.emplace_back(FrameStats{
+				ms(before_update, before_draw),
+				ms(before_draw, before_finish),
+				ms(before_finish, after_finish),
+				Profiler::draw_calls - draw_calls_before,
+				FrameArena::heap_allocations() - heap_before
+			});
+		}
+	}
+
+	//------------ report ------------
+	std::cout << "Ran " << frame << " frames of '" << mode_name << "' (" << warmup << " warmup) at dt = " << dt << "s, " << size.x << "x" << size.y << ", seed " << seed << "." << std::endl;
+	if (!player.done()) std::cout << "NOTE: input script had events past the last frame." << std::endl;
+
+	if (stats.empty()) {
+		std::cout << "No frames measured." << std::endl;
+	} else {
+		auto report = [&stats](char const *name, std::function< double(FrameStats const &) > const &get) {
+			std::vector< double > values;
+			double total = 0.0;
+			for (auto const &s : stats) {
+				values.emplace_back(get(s));
+				total += values.back();
+			}
+			std::sort(values.begin(), values.end());
+			auto percentile = [&values](double p) {
+				return values[std::min(values.size() - 1, size_t(p * (values.size() - 1) + 0.5))];
+			};
+			std::printf("%-18s mean %9.3f  p50 %9.3f  p90 %9.3f  p99 %9.3f  max %9.3f\n",
+				name, total / values.size(), percentile(0.5), percentile(0.9), percentile(0.99), values.back());
+		};
+		report("update (ms)", [](FrameStats const &s){ return s.update_ms; });
+		report("draw (ms)", [](FrameStats const &s){ return s.draw_ms; });
+		report("gpu finish (ms)", [](FrameStats const &s){ return s.finish_ms; });
+		report("frame (ms)", [](FrameStats const &s){ return s.update_ms + s.draw_ms + s.finish_ms; });
+		report("draw calls", [](FrameStats const &s){ return double(s.draw_calls); });
+		report("heap allocations", [](FrameStats const &s){ return double(s.heap_allocations); });
+	}
+
+	if (!csv_file.empty()) {
+		std::ofstream csv(csv_file, std::ios::binary);
+		csv << "frame,update_ms,draw_ms,finish_ms,draw_calls,heap_allocations\n";
+		for (uint32_t i = 0; i < stats.size(); ++i) {
+			FrameStats const &s = stats[i];
+			csv << (warmup + i) << ',' << s.update_ms << ',' << s.draw_ms << ',' << s.finish_ms << ',' << s.draw_calls << ',' << s.heap_allocations << '\n';
+		}
+		std::cout << "Wrote per-frame numbers to '" << csv_file << "'." << std::endl;
+	}
+
+	//------------  teardown ------------
+	Mode::set_current(nullptr);
+	Jobs::shutdown();
+
+	SDL_GL_DeleteContext(context);
+	context = 0;
+
+	SDL_DestroyWindow(window);
+	window = NULL;
+
+	return 0;
+
+#ifdef _WIN32
+	} catch (std::exception const &e) {
+		std::cerr << "Unhandled exception:\n" << e.what() << std::endl;
+		return 1;
+	} catch (...) {
+		std::cerr << "Unhandled exception (unknown type)." << std::endl;
+		throw;
+	}
+#endif
+}
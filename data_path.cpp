@@ -1,8 +1,12 @@
 #include "data_path.hpp"
+#include "Bundle.hpp"
 
 #include <iostream>
+#include <fstream>
 #include <vector>
 #include <sstream>
+#include <mutex>
+#include <set>
 
 #if defined(_WIN32)
 #include <windows.h>
@@ -62,6 +66,93 @@ std::string data_path(std::string const &suffix) {
 	return path + "/" + suffix;
 }
 
+//------------ bundles ------------
+
+namespace {
+	struct Mount {
+		std::string prefix; //directory the bundle is mounted over (with trailing '/')
+		std::unique_ptr< Bundle > bundle;
+	};
+	std::vector< Mount > &get_mounts() {
+		static std::vector< Mount > mounts;
+		return mounts;
+	}
+
+	//paths that are read from disk even when bundled (see unbundle()):
+	// (unlike the mounts, these change while loading threads are reading, so they get a mutex)
+	std::mutex unbundled_mutex;
+	std::set< std::string > &get_unbundled() {
+		static std::set< std::string > unbundled;
+		return unbundled;
+	}
+
+	//read-only stream over a bundle's (mapped) memory:
+	struct BundledBuf : std::streambuf {
+		BundledBuf(char const *data, size_t size) {
+			char *begin = const_cast< char * >(data); //(std::streambuf wants non-const pointers; nothing writes through them)
+			setg(begin, begin, begin + size);
+		}
+		virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+			if (!(which & std::ios_base::in)) return pos_type(off_type(-1));
+			off_type at = off;
+			if (dir == std::ios_base::cur) at += gptr() - eback();
+			else if (dir == std::ios_base::end) at += egptr() - eback();
+			if (at < 0 || at > egptr() - eback()) return pos_type(off_type(-1));
+			setg(eback(), eback() + at, egptr());
+			return pos_type(at);
+		}
+		virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+			return seekoff(off_type(pos), std::ios_base::beg, which);
+		}
+	};
+	struct BundledStream : std::istream {
+		BundledStream(char const *data, size_t size) : std::istream(nullptr), buf(data, size) {
+			rdbuf(&buf);
+		}
+		BundledBuf buf;
+	};
+}
+
+void mount_bundle(std::string const &filename) {
+	Mount mount;
+	mount.prefix = filename.substr(0, filename.rfind('/') + 1);
+	mount.bundle.reset(new Bundle(filename));
+	std::cout << "Mounted bundle '" << filename << "' (" << mount.bundle->files.size() << " files) over '" << mount.prefix << "'." << std::endl;
+	get_mounts().emplace_back(std::move(mount));
+}
+
+void unbundle(std::string const &path) {
+	std::unique_lock< std::mutex > lock(unbundled_mutex);
+	get_unbundled().insert(path);
+}
+
+bool find_bundled(std::string const &path, char const **data, size_t *size) {
+	auto const &mounts = get_mounts();
+	if (mounts.empty()) return false;
+	{
+		std::unique_lock< std::mutex > lock(unbundled_mutex);
+		if (get_unbundled().count(path)) return false;
+	}
+	for (auto m = mounts.rbegin(); m != mounts.rend(); ++m) {
+		if (path.compare(0, m->prefix.size(), m->prefix) != 0) continue;
+		if (Bundle::File const *file = m->bundle->find(path.substr(m->prefix.size()))) {
+			if (data) *data = file->data;
+			if (size) *size = size_t(file->size);
+			return true;
+		}
+	}
+	return false;
+}
+
+std::unique_ptr< std::istream > open_data(std::string const &path) {
+	char const *data = nullptr;
+	size_t size = 0;
+	if (find_bundled(path, &data, &size)) {
+		return std::unique_ptr< std::istream >(new BundledStream(data, size));
+	}
+	return std::unique_ptr< std::istream >(new std::ifstream(path, std::ios::binary));
+}
+
 /* From Rktcr; to be used eventually!
 static std::string make_user_dir(std::string const &app_name) {
 	std::string ret = "";
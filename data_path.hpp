@@ -1,7 +1,26 @@
 #pragma once
 
 #include <string>
+#include <istream>
+#include <memory>
 
 //construct a path based on the location of the currently-running executable:
 // (e.g. if running /home/ix/game0/game.exe will return '/home/ix/game0/' + suffix)
 std::string data_path(std::string const &suffix);
+
+//Mount a bundle (see Bundle.hpp) over the directory that contains it:
+// files under that directory that are in the bundle will be read from the bundle instead of from disk.
+// (later mounts take precedence; only mount before loading starts)
+void mount_bundle(std::string const &filename);
+
+//Read 'path' from disk from now on, even if a mounted bundle has it:
+// (AssetCache calls this when a watched file changes, so edited files are hot-reloaded over the bundle)
+void unbundle(std::string const &path);
+
+//Look up a file in the mounted bundles:
+// returns false if 'path' isn't in any mounted bundle (or was unbundle()'d).
+bool find_bundled(std::string const &path, char const **data, size_t *size);
+
+//Open a file for reading, from a mounted bundle if possible (otherwise from disk):
+// (like std::ifstream, the returned stream is in a failed state if the file couldn't be opened)
+std::unique_ptr< std::istream > open_data(std::string const &path);
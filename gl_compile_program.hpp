@@ -3,9 +3,21 @@
 #include "GL.hpp"
 
 #include <string>
+#include <utility>
+#include <vector>
 
 //compiles+links an OpenGL shader program from source.
+// attributes named in 'attribute_locations' are bound to the given locations
+//  (e.g., so the program can read through another program's vertex arrays).
 // throws on compilation error.
 GLuint gl_compile_program(
 	std::string const &vertex_shader_source,
-	std::string const &fragment_shader_source);
+	std::string const &fragment_shader_source,
+	std::vector< std::pair< std::string, GLuint > > const &attribute_locations = {});
+
+//compiles+links a vertex-shader-only program whose outputs named in 'varyings'
+// are captured (interleaved, in that order) with transform feedback.
+// throws on compilation error.
+GLuint gl_compile_feedback_program(
+	std::string const &vertex_shader_source,
+	std::vector< std::string > const &varyings);
@@ -1,4 +1,5 @@
 #include "load_opus.hpp"
+#include "data_path.hpp"
 
 #include <opusfile.h>
 
@@ -16,9 +17,16 @@ void load_opus(std::string const &filename, std::vector< float > *data_) {
 	std::cout << "loading '" << filename << "'..."; std::cout.flush();
 
 	//will hold opusfile * int a std::unique_ptr so that it will automatically be deleted:
+	//(files in a mounted bundle are decoded straight from the mapped bundle)
+	char const *bundled = nullptr;
+	size_t bundled_size = 0;
+	bool is_bundled = find_bundled(filename, &bundled, &bundled_size);
+
 	int err = 0;
 	std::unique_ptr< OggOpusFile, decltype(&op_free) > op(
-		op_open_file(filename.c_str(), &err), //pointer to hold
+		(is_bundled
+			? op_open_memory(reinterpret_cast< unsigned char const * >(bundled), bundled_size, &err)
+			: op_open_file(filename.c_str(), &err)), //pointer to hold
 		op_free //deletion function
 	);
 	if (err != 0) {
@@ -1,4 +1,5 @@
 #include "load_save_png.hpp"
+#include "data_path.hpp"
 
 #include <png.h>
 
@@ -17,11 +18,11 @@ void save_png(std::ostream &to, unsigned int width, unsigned int height, glm::u8
 void load_png(std::string filename, glm::uvec2 *size, std::vector< glm::u8vec4 > *data, OriginLocation origin) {
 	assert(size);
 
-	std::ifstream file(filename.c_str(), std::ios::binary);
-	if (!file) {
+	std::unique_ptr< std::istream > file = open_data(filename); //(may come from a mounted bundle)
+	if (!*file) {
 		throw std::runtime_error("Failed to open PNG image file '" + filename + "'.");
 	}
-	if (!load_png(file, &size->x, &size->y, data, origin)) {
+	if (!load_png(*file, &size->x, &size->y, data, origin)) {
 		throw std::runtime_error("Failed to read PNG image from '" + filename + "'.");
 	}
 }
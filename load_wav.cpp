@@ -1,4 +1,5 @@
 #include "load_wav.hpp"
+#include "data_path.hpp"
 
 #include <SDL.h>
 
@@ -16,7 +17,13 @@ void load_wav(std::string const &filename, std::vector< float > *data_) {
 	Uint8 *audio_buf = nullptr;
 	Uint32 audio_len = 0;
 
-	SDL_AudioSpec *have = SDL_LoadWAV(filename.c_str(), &audio_spec, &audio_buf, &audio_len);
+	//(files in a mounted bundle are read straight from the mapped bundle)
+	char const *bundled = nullptr;
+	size_t bundled_size = 0;
+	SDL_RWops *rw = (find_bundled(filename, &bundled, &bundled_size)
+		? SDL_RWFromConstMem(bundled, int(bundled_size))
+		: SDL_RWFromFile(filename.c_str(), "rb"));
+	SDL_AudioSpec *have = SDL_LoadWAV_RW(rw, 1, &audio_spec, &audio_buf, &audio_len);
 	if (!have) {
 		throw std::runtime_error("Failed to load WAV file '" + filename + "'; SDL says \"" + std::string(SDL_GetError()) + "\"");
 	}
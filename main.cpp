@@ -7,6 +7,24 @@
 //For asset loading:
 #include "Load.hpp"
 
+//for mounting the asset bundle:
+#include "data_path.hpp"
+
+//for frame timing breakdowns:
+#include "Profiler.hpp"
+
+//for spreading work over all cores:
+#include "Jobs.hpp"
+
+//for recording and replaying sessions:
+#include "InputScript.hpp"
+
+//for per-frame temporary allocations:
+#include "FrameArena.hpp"
+
+//for running updates on their own thread:
+#include "SimulationThread.hpp"
+
 //For sound init:
 #include "Sound.hpp"
 
@@ -22,9 +40,11 @@
 //...and for c++ standard library functions:
 #include <chrono>
 #include <iostream>
+#include <fstream>
 #include <stdexcept>
 #include <memory>
 #include <algorithm>
+#include <random>
 
 #ifdef _WIN32
 extern "C" { uint32_t GetACP(); }
@@ -108,11 +128,57 @@ int main(int argc, char **argv) {
 	//------------ init sound --------------
 	Sound::init();
 
+	//------------ start job system --------------
+	Jobs::init();
+
 	//------------ load assets --------------
+	{ //read assets from the bundle, if there is one (run with --loose-files to read individual files instead):
+		// (files that change on disk while running are hot-reloaded from disk either way; see AssetCache.hpp)
+		bool loose_files = false;
+		for (int i = 1; i < argc; ++i) {
+			if (std::string(argv[i]) == "--loose-files") loose_files = true;
+		}
+		std::string bundle = data_path("assets.bundle");
+		if (!loose_files && std::ifstream(bundle)) {
+			try {
+				mount_bundle(bundle);
+			} catch (std::exception &e) {
+				//(e.g., a truncated or stale bundle -- the loose files are still there)
+				std::cerr << "WARNING: failed to mount '" << bundle << "' (" << e.what() << "); reading individual files instead." << std::endl;
+			}
+		}
+	}
 	call_load_functions();
 
+	//------------ record / replay --------------
+	//run with --record file.txt to save the random seed and input (see InputScript.hpp),
+	// and with --replay file.txt to play exactly the same session back (--seed N just sets the seed):
+	std::string record_file;
+	std::unique_ptr< InputScript > replay;
+	uint32_t seed = std::random_device()();
+	for (int i = 1; i + 1 < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--record") record_file = argv[i+1];
+		if (arg == "--replay") replay = std::make_unique< InputScript >(argv[i+1]);
+		if (arg == "--seed") seed = uint32_t(std::stoul(argv[i+1]));
+	}
+	if (replay && replay->has_seed) seed = replay->seed;
+	std::cout << "Random seed is " << seed << " (run with --seed " << seed << " to use it again)." << std::endl;
+
+	InputScript recording;
+	recording.has_seed = true;
+	recording.seed = seed;
+
+	std::unique_ptr< InputScript::Player > replay_player;
+	if (replay) replay_player = std::make_unique< InputScript::Player >(*replay);
+
 	//------------ create game mode + make current --------------
-	Mode::set_current(std::make_shared< PlayMode >());
+	//run with --gpu-particles to simulate particles with transform feedback (see Particle.hpp):
+	ParticleBackend particle_backend = ParticleBackend::CPU;
+	for (int i = 1; i < argc; ++i) {
+		if (std::string(argv[i]) == "--gpu-particles") particle_backend = ParticleBackend::GPU;
+	}
+	Mode::set_current(std::make_shared< PlayMode >(seed, PlayMode::DefaultBubbles, particle_backend));
 
 	//------------ main loop ------------
 
@@ -131,20 +197,59 @@ int main(int argc, char **argv) {
 	};
 	on_resize();
 
+	//run with --threaded-update to run updates on their own thread (for modes that allow it; see SimulationThread.hpp):
+	bool threaded_update = false;
+	for (int i = 1; i < argc; ++i) {
+		if (std::string(argv[i]) == "--threaded-update") threaded_update = true;
+	}
+	if (threaded_update && (replay || !record_file.empty())) {
+		//(events reach a simulation thread at unpredictable points, so sessions couldn't be reproduced)
+		std::cerr << "WARNING: --threaded-update can't be used while recording or replaying; ignoring it." << std::endl;
+		threaded_update = false;
+	}
+	std::unique_ptr< SimulationThread > simulation; //(running the current mode's updates, if threaded)
+
 	//This will loop until the current mode is set to null:
 	while (Mode::current) {
 		//every pass through the game loop creates one frame of output
 		//  by performing three steps:
+		Profiler::new_frame();
+
+		{ //(0) swap in any assets that were hot-reloaded since the last frame:
+			PROFILE_SCOPE("assets");
+			// (their upload halves, like any other jobs that need the main thread, are queued with Jobs::run_on_main)
+			Jobs::run_main_jobs();
+		}
+
+		if (threaded_update && !(simulation && simulation->mode == Mode::current)) {
+			//mode changed, so (maybe) move its updates to a new simulation thread:
+			simulation.reset();
+			if (Mode::current->threaded_update_ok && Mode::current->fixed_timestep > 0.0f) {
+				simulation = std::make_unique< SimulationThread >(Mode::current);
+			}
+		}
 
 		{ //(1) process any events that are pending
+			PROFILE_SCOPE("events");
 			static SDL_Event evt;
 			while (SDL_PollEvent(&evt) == 1) {
 				//handle resizing:
 				if (evt.type == SDL_WINDOWEVENT && evt.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
 					on_resize();
 				}
+				//record input (tagged with the update it will affect):
+				if (!record_file.empty()) {
+					recording.add(Mode::updates, evt);
+				}
+				//...while replaying, input comes from the replay instead (but quitting still works):
+				if (replay_player && InputScript::stores(evt) && evt.type != SDL_QUIT) continue;
+
 				//handle input:
-				if (Mode::current && Mode::current->handle_event(evt, window_size)) {
+				if (simulation) {
+					//(mode gets the event on the simulation thread, so it isn't known here whether it was handled)
+					simulation->handle_event(evt, window_size);
+				}
+				if (!simulation && Mode::current && Mode::current->handle_event(evt, window_size)) {
 					// mode handled it; great
 				} else if (evt.type == SDL_QUIT) {
 					Mode::set_current(nullptr);
@@ -163,12 +268,35 @@ int main(int argc, char **argv) {
 						px.a = 0xff;
 					}
 					save_png(filename, glm::uvec2(w,h), data.data(), LowerLeftOrigin);
+				} else if (evt.type == SDL_KEYDOWN && evt.key.keysym.sym == SDLK_F3) {
+					// --- profiler overlay toggle ---
+					Profiler::show_overlay = !Profiler::show_overlay;
+				} else if (evt.type == SDL_KEYDOWN && evt.key.keysym.sym == SDLK_F4) {
+					// --- profiler trace key ---
+					Profiler::write_trace("profile.json");
 				}
 			}
 			if (!Mode::current) break;
+
+			if (replay_player) {
+				//deliver this update's events from the replay:
+				while (replay_player->next(Mode::updates, &evt)) {
+					if (evt.type == SDL_QUIT) {
+						Mode::set_current(nullptr);
+						break;
+					}
+					Mode::current->handle_event(evt, window_size);
+				}
+				if (!Mode::current) break;
+				if (replay_player->done()) {
+					std::cout << "Replay finished; input is live again." << std::endl;
+					replay_player.reset();
+				}
+			}
 		}
 
 		{ //(2) call the current mode's "update" function to deal with elapsed time:
+			PROFILE_SCOPE("update");
 			auto current_time = std::chrono::high_resolution_clock::now();
 			static auto previous_time = current_time;
 			float elapsed = std::chrono::duration< float >(current_time - previous_time).count();
@@ -178,21 +306,50 @@ int main(int argc, char **argv) {
 			//lag to avoid spiral of death:
 			elapsed = std::min(0.1f, elapsed);
 
-			Mode::current->update(elapsed);
-			if (!Mode::current) break;
+			if (simulation) {
+				//updates are running on the simulation thread; just blend toward its latest step:
+				Mode::current->interpolate(simulation->alpha());
+			} else if (replay_player) {
+				//replays run exactly one update per frame, so every update sees the same events it did when recorded:
+				// (modes without a fixed_timestep get 1/60s updates, so only fixed-rate modes replay exactly)
+				Mode::update_current(Mode::current->fixed_timestep > 0.0f ? Mode::current->fixed_timestep : 1.0f / 60.0f);
+				if (!Mode::current) break;
+			} else {
+				Mode::update_current(elapsed);
+				if (!Mode::current) break;
+			}
 		}
 
 		{ //(3) call the current mode's "draw" function to produce output:
-		
+			PROFILE_SCOPE("draw");
+			PROFILE_GPU_SCOPE("draw");
 			Mode::current->draw(drawable_size);
 		}
 
-		//Wait until the recently-drawn frame is shown before doing it all again:
-		SDL_GL_SwapWindow(window);
+		if (Profiler::show_overlay) { //(toggle with F3)
+			PROFILE_SCOPE("profiler");
+			Profiler::draw_overlay(drawable_size);
+		}
+
+		{ //Wait until the recently-drawn frame is shown before doing it all again:
+			PROFILE_SCOPE("swap");
+			SDL_GL_SwapWindow(window);
+		}
+
+		//Release this frame's temporary allocations:
+		FrameArena::reset();
 	}
 
 
 	//------------  teardown ------------
+	simulation.reset();
+
+	if (!record_file.empty()) {
+		recording.save(record_file);
+		std::cout << "Recorded " << recording.entries.size() << " input events to '" << record_file << "'." << std::endl;
+	}
+	Jobs::shutdown();
+
 	Sound::shutdown();
 
 	SDL_GL_DeleteContext(context);
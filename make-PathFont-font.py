@@ -506,6 +506,40 @@ for char_glyph in sorted(glyphs.items()):
 	for pair in glyph_lines:
 		out_coords += list(pair)
 
+#build a trie over glyph names (as utf8 bytes) so PathFont::match() can find glyphs without string compares:
+# (the first byte is looked up in a 256-entry table; remaining bytes follow trie edges)
+NONE = 0xffffffff
+out_byte_nodes = [NONE] * 256
+trie = [] #[glyph, {byte: node}]
+def trie_node():
+	trie.append([NONE, dict()])
+	return len(trie)-1
+
+for index, char_glyph in enumerate(sorted(glyphs.items())):
+	name = char_glyph[0].encode('utf8')
+	if len(name) == 0:
+		print("WARNING: glyph with empty name can't be looked up.")
+		continue
+	if out_byte_nodes[name[0]] == NONE:
+		out_byte_nodes[name[0]] = trie_node()
+	node = out_byte_nodes[name[0]]
+	for b in name[1:]:
+		if b not in trie[node][1]:
+			trie[node][1][b] = trie_node()
+		node = trie[node][1][b]
+	if trie[node][0] != NONE:
+		print("WARNING: duplicate glyph for '" + char_glyph[0] + "'.")
+	else:
+		trie[node][0] = index
+
+out_trie_nodes = []
+out_trie_edges = []
+for node in trie:
+	edge_begin = len(out_trie_edges)
+	for b in sorted(node[1].keys()):
+		out_trie_edges.append((b, node[1][b]))
+	out_trie_nodes.append((node[0], edge_begin, len(out_trie_edges)))
+
 print("Font covers: " + ", ".join(map(lambda x: "'" + x + "'", sorted(glyphs.keys()))))
 missing = []
 for m in range(0x20, 0x7f):
@@ -553,8 +587,24 @@ w('\tconstexpr const float font_coords[' + str(len(out_coords)) + '] = {\n')
 wd(out_coords, "{:.6f}f", 6)
 w('\t};\n')
 
+def none_or(x):
+	return '-1U' if x == NONE else str(x)
+
+w('\tconstexpr const uint32_t font_byte_nodes[256] = {\n')
+wd(list(map(none_or, out_byte_nodes)), "{}", 16)
+w('\t};\n')
+
+w('\tconstexpr const PathFont::TrieNode font_trie_nodes[' + str(len(out_trie_nodes)) + '] = {\n')
+wd(list(map(lambda n: '{' + none_or(n[0]) + ', ' + str(n[1]) + ', ' + str(n[2]) + '}', out_trie_nodes)), "{}", 6)
+w('\t};\n')
+
+#(arrays can't be empty, so there is always at least one [unused] edge)
+w('\tconstexpr const PathFont::TrieEdge font_trie_edges[' + str(max(1, len(out_trie_edges))) + '] = {\n')
+wd(list(map(lambda e: '{' + str(e[0]) + ', ' + none_or(e[1]) + '}', out_trie_edges if len(out_trie_edges) else [(0, NONE)])), "{}", 6)
+w('\t};\n')
+
 
 w('}\n')
-w('PathFont PathFont::font(font_glyphs, font_glyph_widths, font_glyph_char_starts, font_chars, font_glyph_coord_starts, font_coords);\n')
+w('PathFont PathFont::font(font_glyphs, font_glyph_widths, font_glyph_char_starts, font_chars, font_glyph_coord_starts, font_coords, font_byte_nodes, font_trie_nodes, font_trie_edges);\n')
 
 cppfile.close()
@@ -0,0 +1,639 @@
+//pack-meshes: triangulates and packs a raw mesh dump (from scenes/dump-meshes.py) into a .pnct file.
+// usage: pack-meshes <in.meshdump> <out.pnct> [-jN] [--lods=N]
+//
+// Does the same job as the per-triangle loop in scenes/export-meshes.py, but
+// in bulk and on every core, so blender only has to copy out raw arrays.
+//
+// With --lods=N, also writes up to N simplified versions of each mesh (each
+// with about half the triangles of the one before), made by quadric error
+// metric edge collapse, in an extra 'lod0' chunk (see Mesh::LOD).
+
+#include "read_write_chunk.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+//Chunk contents of the dump file (see dump-meshes.py for the writer):
+struct MeshEntry {
+	uint32_t name_begin, name_end;
+	uint32_t vertex_begin, vertex_end;
+	uint32_t loop_begin, loop_end;
+	uint32_t poly_begin, poly_end;
+};
+static_assert(sizeof(MeshEntry) == 8*4, "MeshEntry is packed.");
+
+struct PolyEntry {
+	uint32_t loop_start; //relative to mesh's loop_begin
+	uint32_t loop_total;
+};
+static_assert(sizeof(PolyEntry) == 2*4, "PolyEntry is packed.");
+
+//Output formats (must match MeshBuffer's reader in Mesh.cpp):
+struct Vertex {
+	glm::vec3 Position;
+	glm::vec3 Normal;
+	glm::u8vec4 Color;
+	glm::vec2 TexCoord;
+};
+static_assert(sizeof(Vertex) == 3*4+3*4+4*1+2*4, "Vertex is packed.");
+
+struct IndexEntry {
+	uint32_t name_begin, name_end;
+	uint32_t vertex_begin, vertex_end;
+};
+static_assert(sizeof(IndexEntry) == 16, "Index entry should be packed");
+
+struct LodEntry {
+	uint32_t name_begin, name_end; //mesh name (as in the index)
+	uint32_t level; //1 for the first simplified version, 2 for the next, ...
+	uint32_t vertex_begin, vertex_end;
+	float error; //estimated distance between this level's surface and the original's
+};
+static_assert(sizeof(LodEntry) == 24, "LOD entry should be packed");
+
+struct Dump {
+	std::vector< char > names;
+	std::vector< MeshEntry > meshes;
+	std::vector< glm::vec3 > positions;
+	std::vector< uint32_t > loop_vertices;
+	std::vector< glm::vec3 > loop_normals;
+	std::vector< glm::vec4 > loop_colors;
+	std::vector< glm::vec2 > loop_uvs;
+	std::vector< PolyEntry > polys;
+};
+
+static void validate(Dump const &dump) {
+	size_t loops = dump.loop_vertices.size();
+	if (dump.loop_normals.size() != loops || dump.loop_colors.size() != loops || dump.loop_uvs.size() != loops) {
+		throw std::runtime_error("Per-loop arrays in dump have mismatched lengths.");
+	}
+	for (auto const &m : dump.meshes) {
+		if (!(m.name_begin <= m.name_end && m.name_end <= dump.names.size())) {
+			throw std::runtime_error("Mesh entry has out-of-range name begin/end.");
+		}
+		std::string name(dump.names.begin() + m.name_begin, dump.names.begin() + m.name_end);
+		if (!(m.vertex_begin <= m.vertex_end && m.vertex_end <= dump.positions.size())) {
+			throw std::runtime_error("Mesh '" + name + "' has out-of-range vertex begin/end.");
+		}
+		if (!(m.loop_begin <= m.loop_end && m.loop_end <= loops)) {
+			throw std::runtime_error("Mesh '" + name + "' has out-of-range loop begin/end.");
+		}
+		if (!(m.poly_begin <= m.poly_end && m.poly_end <= dump.polys.size())) {
+			throw std::runtime_error("Mesh '" + name + "' has out-of-range polygon begin/end.");
+		}
+		uint32_t vertex_count = m.vertex_end - m.vertex_begin;
+		for (uint32_t l = m.loop_begin; l < m.loop_end; ++l) {
+			if (dump.loop_vertices[l] >= vertex_count) {
+				throw std::runtime_error("Mesh '" + name + "' has loop with out-of-range vertex index.");
+			}
+		}
+		uint32_t loop_count = m.loop_end - m.loop_begin;
+		for (uint32_t p = m.poly_begin; p < m.poly_end; ++p) {
+			PolyEntry const &poly = dump.polys[p];
+			if (poly.loop_total < 3 || poly.loop_start > loop_count || poly.loop_total > loop_count - poly.loop_start) {
+				throw std::runtime_error("Mesh '" + name + "' has polygon with invalid loop range.");
+			}
+		}
+		for (uint32_t v = m.vertex_begin; v < m.vertex_end; ++v) {
+			glm::vec3 const &p = dump.positions[v];
+			if (!(std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z))) {
+				throw std::runtime_error("Mesh '" + name + "' has non-finite vertex position.");
+			}
+		}
+	}
+}
+
+//Triangulate one polygon given by loop indices 'loops' (absolute indices into loop arrays) of mesh 'm':
+// writes exactly loops.size()-2 triangles (as loop indices) to 'out'
+static void triangulate(Dump const &dump, MeshEntry const &m, std::vector< uint32_t > const &loops, uint32_t *out) {
+	auto pos = [&](uint32_t loop) -> glm::vec3 const & {
+		return dump.positions[m.vertex_begin + dump.loop_vertices[loop]];
+	};
+
+	if (loops.size() == 3) {
+		out[0] = loops[0]; out[1] = loops[1]; out[2] = loops[2];
+		return;
+	}
+
+	if (loops.size() == 4) {
+		//split along the shorter diagonal (approximates blender's 'BEAUTY' quad method):
+		float d02 = glm::length(pos(loops[2]) - pos(loops[0]));
+		float d13 = glm::length(pos(loops[3]) - pos(loops[1]));
+		if (d02 <= d13) {
+			out[0] = loops[0]; out[1] = loops[1]; out[2] = loops[2];
+			out[3] = loops[0]; out[4] = loops[2]; out[5] = loops[3];
+		} else {
+			out[0] = loops[1]; out[1] = loops[2]; out[2] = loops[3];
+			out[3] = loops[1]; out[4] = loops[3]; out[5] = loops[0];
+		}
+		return;
+	}
+
+	//n-gons: ear clipping in the polygon's plane (normal from Newell's method):
+	glm::vec3 normal = glm::vec3(0.0f);
+	for (uint32_t i = 0; i < loops.size(); ++i) {
+		glm::vec3 const &a = pos(loops[i]);
+		glm::vec3 const &b = pos(loops[(i + 1) % loops.size()]);
+		normal += glm::cross(a, b);
+	}
+
+	std::vector< uint32_t > remaining = loops;
+	uint32_t written = 0;
+	auto emit = [&](uint32_t a, uint32_t b, uint32_t c) {
+		out[written++] = a; out[written++] = b; out[written++] = c;
+	};
+
+	while (remaining.size() > 3) {
+		bool clipped = false;
+		for (uint32_t i = 0; i < remaining.size(); ++i) {
+			uint32_t ia = remaining[(i + remaining.size() - 1) % remaining.size()];
+			uint32_t ib = remaining[i];
+			uint32_t ic = remaining[(i + 1) % remaining.size()];
+			glm::vec3 const &a = pos(ia);
+			glm::vec3 const &b = pos(ib);
+			glm::vec3 const &c = pos(ic);
+			//reflex (or degenerate) corner can't be an ear:
+			if (glm::dot(glm::cross(b - a, c - b), normal) <= 0.0f) continue;
+			//no other vertex may be inside the ear:
+			bool empty = true;
+			for (uint32_t j : remaining) {
+				if (j == ia || j == ib || j == ic) continue;
+				glm::vec3 const &p = pos(j);
+				if (glm::dot(glm::cross(b - a, p - a), normal) >= 0.0f
+				 && glm::dot(glm::cross(c - b, p - b), normal) >= 0.0f
+				 && glm::dot(glm::cross(a - c, p - c), normal) >= 0.0f) {
+					empty = false;
+					break;
+				}
+			}
+			if (!empty) continue;
+			emit(ia, ib, ic);
+			remaining.erase(remaining.begin() + i);
+			clipped = true;
+			break;
+		}
+		if (!clipped) {
+			//self-intersecting or otherwise degenerate polygon; fall back to a fan:
+			for (uint32_t i = 1; i + 1 < remaining.size(); ++i) {
+				emit(remaining[0], remaining[i], remaining[i+1]);
+			}
+			return;
+		}
+	}
+	emit(remaining[0], remaining[1], remaining[2]);
+}
+
+//------------ simplification --------------
+
+//Sum of squared distances to a set of (weighted) planes, as a symmetric 4x4 matrix:
+struct Quadric {
+	double m[10] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 }; //upper triangle: aa ab ac ad bb bc bd cc cd dd
+	double area = 0.0; //total area of the faces whose planes were added
+
+	//add the plane dot(n,x) + d = 0 with weight w:
+	void add_plane(glm::dvec3 const &n, double d, double w) {
+		m[0] += w*n.x*n.x; m[1] += w*n.x*n.y; m[2] += w*n.x*n.z; m[3] += w*n.x*d;
+		m[4] += w*n.y*n.y; m[5] += w*n.y*n.z; m[6] += w*n.y*d;
+		m[7] += w*n.z*n.z; m[8] += w*n.z*d;
+		m[9] += w*d*d;
+	}
+	Quadric &operator+=(Quadric const &o) {
+		for (uint32_t i = 0; i < 10; ++i) m[i] += o.m[i];
+		area += o.area;
+		return *this;
+	}
+	//weighted sum of squared distances from p to the planes:
+	double error(glm::dvec3 const &p) const {
+		return m[0]*p.x*p.x + 2.0*m[1]*p.x*p.y + 2.0*m[2]*p.x*p.z + 2.0*m[3]*p.x
+		     + m[4]*p.y*p.y + 2.0*m[5]*p.y*p.z + 2.0*m[6]*p.y
+		     + m[7]*p.z*p.z + 2.0*m[8]*p.z
+		     + m[9];
+	}
+};
+
+struct Level {
+	std::vector< Vertex > vertices;
+	float error = 0.0f;
+};
+
+//Simplify one mesh ('count' vertices, three per triangle) by collapsing edges in order of quadric error
+// (Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics", 1997), stopping at each of
+// 'levels' successive halvings of the triangle count to write out a level:
+// (vertices with the same position are welded; each triangle corner keeps its own normal, color, and texcoord)
+static std::vector< Level > simplify(Vertex const *tris, uint32_t count, uint32_t levels) {
+	std::vector< Level > out;
+	uint32_t tri_count = count / 3;
+
+	//weld positions:
+	std::vector< glm::dvec3 > positions;
+	std::vector< uint32_t > corner_vertex(count); //position index of each triangle corner
+	{
+		std::map< std::tuple< float, float, float >, uint32_t > welded;
+		for (uint32_t c = 0; c < count; ++c) {
+			glm::vec3 const &p = tris[c].Position;
+			auto ret = welded.emplace(std::make_tuple(p.x, p.y, p.z), uint32_t(positions.size()));
+			if (ret.second) positions.emplace_back(p);
+			corner_vertex[c] = ret.first->second;
+		}
+	}
+
+	std::vector< bool > tri_alive(tri_count, true);
+	std::vector< std::vector< uint32_t > > vertex_tris(positions.size());
+	std::vector< Quadric > quadrics(positions.size());
+	uint32_t live_tris = tri_count;
+
+	auto tri_normal = [&](uint32_t t, uint32_t moved, glm::dvec3 const &to) {
+		glm::dvec3 p[3];
+		for (uint32_t k = 0; k < 3; ++k) {
+			uint32_t v = corner_vertex[3*t+k];
+			p[k] = (v == moved ? to : positions[v]);
+		}
+		return glm::cross(p[1] - p[0], p[2] - p[0]);
+	};
+
+	//face quadrics (area weighted), and which edges are on the boundary:
+	std::map< std::pair< uint32_t, uint32_t >, std::pair< uint32_t, uint32_t > > edges; //(a < b) -> (uses, a triangle using it)
+	for (uint32_t t = 0; t < tri_count; ++t) {
+		uint32_t const *v = &corner_vertex[3*t];
+		if (v[0] == v[1] || v[1] == v[2] || v[2] == v[0]) { //degenerate after welding
+			tri_alive[t] = false;
+			live_tris -= 1;
+			continue;
+		}
+		glm::dvec3 n = tri_normal(t, -1U, glm::dvec3(0.0));
+		double length = glm::length(n);
+		if (length > 0.0) {
+			n /= length;
+			Quadric q;
+			q.add_plane(n, -glm::dot(n, positions[v[0]]), 0.5 * length);
+			q.area = 0.5 * length;
+			for (uint32_t k = 0; k < 3; ++k) quadrics[v[k]] += q;
+		}
+		for (uint32_t k = 0; k < 3; ++k) {
+			vertex_tris[v[k]].emplace_back(t);
+			auto &e = edges[std::minmax(v[k], v[(k+1)%3])];
+			e.first += 1;
+			e.second = t;
+		}
+	}
+
+	//boundary edges get a heavily weighted plane at right angles to their triangle, so outlines stay put:
+	constexpr double BoundaryWeight = 100.0;
+	for (auto const &[edge, use] : edges) {
+		if (use.first != 1) continue;
+		glm::dvec3 along = positions[edge.second] - positions[edge.first];
+		glm::dvec3 n = glm::cross(along, tri_normal(use.second, -1U, glm::dvec3(0.0)));
+		double length = glm::length(n);
+		if (length == 0.0) continue;
+		n /= length;
+		double w = BoundaryWeight * glm::dot(along, along);
+		quadrics[edge.first].add_plane(n, -glm::dot(n, positions[edge.first]), w);
+		quadrics[edge.second].add_plane(n, -glm::dot(n, positions[edge.first]), w);
+	}
+
+	//candidate collapses, cheapest first (entries go stale when an endpoint changes; 'version' detects that):
+	struct Collapse {
+		double cost;
+		uint32_t a, b; //collapse b into a...
+		glm::dvec3 to; //...and move a here
+		uint32_t version_a, version_b;
+		bool operator>(Collapse const &o) const { return cost > o.cost; }
+	};
+	std::priority_queue< Collapse, std::vector< Collapse >, std::greater< Collapse > > queue;
+	std::vector< uint32_t > version(positions.size(), 0);
+	std::vector< bool > vertex_alive(positions.size(), true);
+
+	auto push = [&](uint32_t a, uint32_t b) {
+		Quadric q = quadrics[a];
+		q += quadrics[b];
+		//(optimal placement needs a 3x3 solve that can be ill-conditioned; the best of the ends and middle is robust)
+		glm::dvec3 options[3] = { positions[a], positions[b], 0.5 * (positions[a] + positions[b]) };
+		Collapse c{ q.error(options[0]), a, b, options[0], version[a], version[b] };
+		for (uint32_t i = 1; i < 3; ++i) {
+			double cost = q.error(options[i]);
+			if (cost < c.cost) { c.cost = cost; c.to = options[i]; }
+		}
+		c.cost = std::max(0.0, c.cost) / std::max(q.area, 1e-12); //(mean squared distance, so sizes of meshes don't matter)
+		queue.push(c);
+	};
+	for (auto const &[edge, use] : edges) {
+		if (tri_alive[use.second]) push(edge.first, edge.second);
+	}
+
+	auto write_level = [&](double error) {
+		Level level;
+		level.error = float(std::sqrt(error));
+		level.vertices.reserve(3 * live_tris);
+		for (uint32_t t = 0; t < tri_count; ++t) {
+			if (!tri_alive[t]) continue;
+			for (uint32_t k = 0; k < 3; ++k) {
+				Vertex vertex = tris[3*t+k];
+				vertex.Position = glm::vec3(positions[corner_vertex[3*t+k]]);
+				level.vertices.emplace_back(vertex);
+			}
+		}
+		out.emplace_back(std::move(level));
+	};
+
+	double max_error = 0.0;
+	std::vector< uint32_t > neighbors;
+	uint32_t target = tri_count;
+	for (uint32_t l = 0; l < levels; ++l) {
+		uint32_t before = live_tris;
+		target /= 2;
+		if (target < 4) break; //(not worth it for tiny meshes)
+
+		while (live_tris > target && !queue.empty()) {
+			Collapse c = queue.top();
+			queue.pop();
+			if (!vertex_alive[c.a] || !vertex_alive[c.b] || version[c.a] != c.version_a || version[c.b] != c.version_b) continue;
+
+			//don't flip (or squash flat) any triangle that survives the collapse:
+			bool flips = false;
+			for (uint32_t end : { c.a, c.b }) {
+				for (uint32_t t : vertex_tris[end]) {
+					if (!tri_alive[t]) continue;
+					uint32_t const *v = &corner_vertex[3*t];
+					bool has_a = (v[0] == c.a || v[1] == c.a || v[2] == c.a);
+					bool has_b = (v[0] == c.b || v[1] == c.b || v[2] == c.b);
+					if (has_a && has_b) continue; //(removed by the collapse)
+					glm::dvec3 n0 = tri_normal(t, -1U, glm::dvec3(0.0));
+					glm::dvec3 n1 = tri_normal(t, end, c.to);
+					if (glm::dot(n0, n1) <= 0.0) { flips = true; break; }
+				}
+				if (flips) break;
+			}
+			if (flips) continue;
+
+			//collapse:
+			max_error = std::max(max_error, c.cost);
+			positions[c.a] = c.to;
+			quadrics[c.a] += quadrics[c.b];
+			vertex_alive[c.b] = false;
+			version[c.a] += 1;
+			for (uint32_t t : vertex_tris[c.b]) {
+				if (!tri_alive[t]) continue;
+				uint32_t *v = &corner_vertex[3*t];
+				if (v[0] == c.a || v[1] == c.a || v[2] == c.a) {
+					tri_alive[t] = false;
+					live_tris -= 1;
+				} else {
+					for (uint32_t k = 0; k < 3; ++k) {
+						if (v[k] == c.b) v[k] = c.a;
+					}
+					vertex_tris[c.a].emplace_back(t);
+				}
+			}
+			vertex_tris[c.b].clear();
+			auto &a_tris = vertex_tris[c.a];
+			a_tris.erase(std::remove_if(a_tris.begin(), a_tris.end(), [&](uint32_t t) { return !tri_alive[t]; }), a_tris.end());
+
+			//re-cost edges around the moved vertex:
+			neighbors.clear();
+			for (uint32_t t : a_tris) {
+				for (uint32_t k = 0; k < 3; ++k) {
+					uint32_t v = corner_vertex[3*t+k];
+					if (v != c.a) neighbors.emplace_back(v);
+				}
+			}
+			std::sort(neighbors.begin(), neighbors.end());
+			neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+			for (uint32_t n : neighbors) push(c.a, n);
+		}
+
+		if (live_tris == before) break; //(nothing left that can collapse)
+		write_level(max_error);
+	}
+
+	return out;
+}
+
+static int pack_meshes(int argc, char **argv) {
+	std::string infile, outfile;
+	uint32_t jobs = std::max(1U, std::thread::hardware_concurrency());
+	uint32_t lod_levels = 0;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg.size() > 2 && arg.substr(0,2) == "-j") {
+			jobs = std::max(1, std::stoi(arg.substr(2)));
+		} else if (arg.size() > 7 && arg.substr(0,7) == "--lods=") {
+			lod_levels = uint32_t(std::max(0, std::stoi(arg.substr(7))));
+		} else if (infile.empty()) {
+			infile = arg;
+		} else if (outfile.empty()) {
+			outfile = arg;
+		} else {
+			infile = ""; //too many arguments
+			break;
+		}
+	}
+	if (infile.empty() || outfile.empty()) {
+		std::cerr << "Usage:\n\t" << argv[0] << " <in.meshdump> <out.pnct> [-jN] [--lods=N]\nTriangulates and packs meshes dumped by scenes/dump-meshes.py.\n"
+			"With --lods=N, also writes up to N simplified versions of each mesh.\n";
+		return 1;
+	}
+
+	auto before = std::chrono::high_resolution_clock::now();
+
+	//------------ read dump --------------
+	Dump dump;
+	{
+		std::ifstream file(infile, std::ios::binary);
+		if (!file) {
+			std::cerr << "Failed to open '" << infile << "'." << std::endl;
+			return 1;
+		}
+		read_chunk(file, "str0", &dump.names);
+		read_chunk(file, "msh0", &dump.meshes);
+		read_chunk(file, "pos0", &dump.positions);
+		read_chunk(file, "lvi0", &dump.loop_vertices);
+		read_chunk(file, "lnm0", &dump.loop_normals);
+		read_chunk(file, "lcl0", &dump.loop_colors);
+		read_chunk(file, "luv0", &dump.loop_uvs);
+		read_chunk(file, "ply0", &dump.polys);
+		if (file.peek() != EOF) {
+			std::cerr << "WARNING: trailing data in mesh dump '" << infile << "'" << std::endl;
+		}
+	}
+	validate(dump);
+
+	//------------ assign output ranges --------------
+	//every polygon with n loops becomes n-2 triangles, so output offsets are a prefix sum:
+	std::vector< uint32_t > poly_mesh(dump.polys.size(), -1U); //which mesh owns each polygon
+	std::vector< uint32_t > poly_first(dump.polys.size() + 1, 0); //first output vertex for each polygon
+	std::vector< IndexEntry > index;
+	index.reserve(dump.meshes.size());
+	uint32_t vertex_count = 0;
+	for (uint32_t mi = 0; mi < dump.meshes.size(); ++mi) {
+		MeshEntry const &m = dump.meshes[mi];
+		IndexEntry entry;
+		entry.name_begin = m.name_begin;
+		entry.name_end = m.name_end;
+		entry.vertex_begin = vertex_count;
+		for (uint32_t p = m.poly_begin; p < m.poly_end; ++p) {
+			if (poly_mesh[p] != -1U) throw std::runtime_error("Polygon shared between meshes in dump.");
+			poly_mesh[p] = mi;
+			poly_first[p] = vertex_count;
+			vertex_count += 3 * (dump.polys[p].loop_total - 2);
+		}
+		entry.vertex_end = vertex_count;
+		index.emplace_back(entry);
+	}
+
+	//------------ triangulate + pack (in parallel) --------------
+	std::vector< Vertex > data(vertex_count);
+
+	//polygons are handed out in blocks so that threads stay busy even when one mesh dominates:
+	constexpr uint32_t BlockSize = 4096;
+	std::atomic< uint32_t > next_block(0);
+	auto worker = [&]() {
+		std::vector< uint32_t > loops;
+		std::vector< uint32_t > tris;
+		while (true) {
+			uint32_t begin = next_block.fetch_add(BlockSize);
+			if (begin >= dump.polys.size()) break;
+			uint32_t end = std::min< uint32_t >(begin + BlockSize, uint32_t(dump.polys.size()));
+			for (uint32_t p = begin; p < end; ++p) {
+				if (poly_mesh[p] == -1U) continue; //polygon not referenced by any mesh
+				MeshEntry const &m = dump.meshes[poly_mesh[p]];
+				PolyEntry const &poly = dump.polys[p];
+
+				loops.clear();
+				for (uint32_t l = 0; l < poly.loop_total; ++l) {
+					loops.emplace_back(m.loop_begin + poly.loop_start + l);
+				}
+				tris.resize(3 * (loops.size() - 2));
+				triangulate(dump, m, loops, tris.data());
+
+				Vertex *out = &data[poly_first[p]];
+				for (uint32_t loop : tris) {
+					out->Position = dump.positions[m.vertex_begin + dump.loop_vertices[loop]];
+					out->Normal = dump.loop_normals[loop];
+					glm::vec4 const &col = dump.loop_colors[loop];
+					//same conversion as export-meshes.py (alpha is always opaque):
+					out->Color = glm::u8vec4(
+						uint8_t(glm::clamp(col.r, 0.0f, 1.0f) * 255),
+						uint8_t(glm::clamp(col.g, 0.0f, 1.0f) * 255),
+						uint8_t(glm::clamp(col.b, 0.0f, 1.0f) * 255),
+						uint8_t(255)
+					);
+					out->TexCoord = dump.loop_uvs[loop];
+					++out;
+				}
+			}
+		}
+	};
+
+	{
+		std::vector< std::thread > threads;
+		for (uint32_t t = 1; t < jobs; ++t) {
+			threads.emplace_back(worker);
+		}
+		worker();
+		for (auto &thread : threads) {
+			thread.join();
+		}
+	}
+
+	//------------ simplify (in parallel) --------------
+	//levels go after all the full-detail meshes, so the index ranges don't change:
+	std::vector< LodEntry > lods;
+	if (lod_levels > 0) {
+		std::vector< std::vector< Level > > mesh_levels(index.size());
+		std::atomic< uint32_t > next_mesh(0);
+		auto simplify_worker = [&]() {
+			while (true) {
+				uint32_t mi = next_mesh.fetch_add(1);
+				if (mi >= index.size()) break;
+				IndexEntry const &entry = index[mi];
+				mesh_levels[mi] = simplify(data.data() + entry.vertex_begin, entry.vertex_end - entry.vertex_begin, lod_levels);
+			}
+		};
+		{
+			std::vector< std::thread > threads;
+			for (uint32_t t = 1; t < jobs; ++t) {
+				threads.emplace_back(simplify_worker);
+			}
+			simplify_worker();
+			for (auto &thread : threads) {
+				thread.join();
+			}
+		}
+
+		for (uint32_t mi = 0; mi < index.size(); ++mi) {
+			for (uint32_t l = 0; l < mesh_levels[mi].size(); ++l) {
+				Level const &level = mesh_levels[mi][l];
+				LodEntry entry;
+				entry.name_begin = index[mi].name_begin;
+				entry.name_end = index[mi].name_end;
+				entry.level = l + 1;
+				entry.vertex_begin = uint32_t(data.size());
+				data.insert(data.end(), level.vertices.begin(), level.vertices.end());
+				entry.vertex_end = uint32_t(data.size());
+				entry.error = level.error;
+				lods.emplace_back(entry);
+			}
+		}
+	}
+
+	//------------ write output --------------
+	{
+		std::ofstream file(outfile, std::ios::binary);
+		write_chunk("pnct", data, &file);
+		write_chunk("str0", dump.names, &file);
+		write_chunk("idx0", index, &file);
+		if (!lods.empty()) write_chunk("lod0", lods, &file);
+		if (!file) {
+			std::cerr << "Failed to write '" << outfile << "'." << std::endl;
+			return 1;
+		}
+	}
+
+	{ //validate by reading back with the same chunk reader the game uses:
+		std::ifstream file(outfile, std::ios::binary);
+		std::vector< Vertex > check_data;
+		std::vector< char > check_strings;
+		std::vector< IndexEntry > check_index;
+		std::vector< LodEntry > check_lods;
+		read_chunk(file, "pnct", &check_data);
+		read_chunk(file, "str0", &check_strings);
+		read_chunk(file, "idx0", &check_index);
+		if (!lods.empty()) read_chunk(file, "lod0", &check_lods);
+		if (check_data.size() != data.size() || check_strings.size() != dump.names.size() || check_index.size() != index.size()
+		 || check_lods.size() != lods.size() || file.peek() != EOF) {
+			std::cerr << "Output file '" << outfile << "' did not read back as written." << std::endl;
+			return 1;
+		}
+	}
+
+	auto after = std::chrono::high_resolution_clock::now();
+	std::cout << "Wrote " << dump.meshes.size() << " meshes (" << vertex_count << " vertices";
+	if (!lods.empty()) std::cout << ", plus " << lods.size() << " simplified levels in " << (data.size() - vertex_count) << " vertices";
+	std::cout << ") to '" << outfile << "' in "
+		<< std::chrono::duration< double >(after - before).count() << " seconds using " << jobs << " threads." << std::endl;
+
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	//(reading a malformed dump, or reading back the output, throws):
+	try {
+		return pack_meshes(argc, argv);
+	} catch (std::exception &e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,196 @@
+#!/usr/bin/env python
+
+#Fast path for 'export-meshes.py': dumps raw mesh arrays (via foreach_get) for 'pack-meshes' to triangulate and pack.
+
+#Note: Script meant to be executed within blender 2.9, as per:
+#blender --background --python dump-meshes.py -- [...see below...]
+
+import sys,re
+
+args = []
+for i in range(0,len(sys.argv)):
+	if sys.argv[i] == '--':
+		args = sys.argv[i+1:]
+
+if len(args) != 2:
+	print("\n\nUsage:\nblender --background --python dump-meshes.py -- <infile.blend[:collection]> <outfile.meshdump>\nDumps the meshes referenced by all objects in the specified collection(s) (default: all objects) as raw arrays.\nRun 'pack-meshes <outfile.meshdump> <outfile.pnct>' afterward to produce a .pnct file.\n")
+	exit(1)
+
+import bpy
+import numpy
+
+infile = args[0]
+collection_name = None
+m = re.match(r'^(.*):([^:]+)$', infile)
+if m:
+	infile = m.group(1)
+	collection_name = m.group(2)
+outfile = args[1]
+
+assert outfile.endswith(".meshdump")
+
+print("Will dump meshes referenced from ",end="")
+if collection_name:
+	print("collection '" + collection_name + "'",end="")
+else:
+	print('master collection',end="")
+print(" of '" + infile + "' to '" + outfile + "'.")
+
+import struct
+
+bpy.ops.wm.open_mainfile(filepath=infile)
+
+if collection_name:
+	if not collection_name in bpy.data.collections:
+		print("ERROR: Collection '" + collection_name + "' does not exist in scene.")
+		exit(1)
+	collection = bpy.data.collections[collection_name]
+else:
+	collection = bpy.context.scene.collection
+
+
+#meshes to write (same selection rules as export-meshes.py):
+to_write = set()
+did_collections = set()
+def add_meshes(from_collection):
+	global to_write
+	global did_collections
+	if from_collection in did_collections:
+		return
+	did_collections.add(from_collection)
+
+	if from_collection.name[0] == '_':
+		print("Skipping collection '" + from_collection.name + "' because its name starts with an underscore.")
+		return
+
+	for obj in from_collection.objects:
+		if obj.type == 'MESH':
+			if obj.data.name[0] == '_':
+				print("Skipping mesh '" + obj.data.name + "' because its name starts with an underscore.")
+			else:
+				to_write.add(obj.data)
+		if obj.instance_collection:
+			add_meshes(obj.instance_collection)
+	for child in from_collection.children:
+		add_meshes(child)
+
+add_meshes(collection)
+
+depsgraph = bpy.context.evaluated_depsgraph_get()
+
+#Dump file format (every chunk is 'magic, byte length, data' as in read_write_chunk.hpp):
+# str0 len < char > * [mesh names]
+# msh0 len < name_begin name_end vertex_begin vertex_end loop_begin loop_end poly_begin poly_end > * [uint32 ranges into the arrays below]
+# pos0 len < float3 > * [vertex positions]
+# lvi0 len < uint32 > * [loop vertex index (relative to mesh's vertex_begin)]
+# lnm0 len < float3 > * [loop (split) normals]
+# lcl0 len < float4 > * [loop colors (white if mesh has no color layer)]
+# luv0 len < float2 > * [loop texture coordinates (zero if mesh has no uv layer)]
+# ply0 len < uint32 uint32 > * [polygon loop start (relative to mesh's loop_begin) and loop count]
+
+strings = b''
+entries = []
+positions = []
+loop_vertices = []
+loop_normals = []
+loop_colors = []
+loop_uvs = []
+polys = []
+
+vertex_count = 0
+loop_count = 0
+poly_count = 0
+
+for obj in bpy.data.objects:
+	if obj.data in to_write:
+		to_write.remove(obj.data)
+	else:
+		continue
+
+	name = obj.data.name
+	print("Dumping '" + name + "'...")
+
+	#apply modifiers by evaluating the object:
+	evaluated = obj.evaluated_get(depsgraph)
+	mesh = evaluated.to_mesh()
+
+	#compute normals (respecting face smoothing):
+	mesh.calc_normals_split()
+
+	v = numpy.empty(len(mesh.vertices) * 3, dtype=numpy.float32)
+	mesh.vertices.foreach_get('co', v)
+
+	lvi = numpy.empty(len(mesh.loops), dtype=numpy.int32)
+	mesh.loops.foreach_get('vertex_index', lvi)
+
+	lnm = numpy.empty(len(mesh.loops) * 3, dtype=numpy.float32)
+	mesh.loops.foreach_get('normal', lnm)
+
+	if len(mesh.vertex_colors) == 0:
+		print("WARNING: trying to export color data, but object '" + name + "' does not have color data; will output 0xffffffff")
+		lcl = numpy.ones(len(mesh.loops) * 4, dtype=numpy.float32)
+	else:
+		if len(mesh.vertex_colors) != 1:
+			print("WARNING: object '" + name + "' has multiple vertex color layers; only exporting '" + mesh.vertex_colors.active.name + "'")
+		lcl = numpy.empty(len(mesh.loops) * 4, dtype=numpy.float32)
+		mesh.vertex_colors.active.data.foreach_get('color', lcl)
+
+	if len(mesh.uv_layers) == 0:
+		print("WARNING: trying to export texcoord data, but object '" + name + "' does not uv data; will output (0.0, 0.0)")
+		luv = numpy.zeros(len(mesh.loops) * 2, dtype=numpy.float32)
+	else:
+		if len(mesh.uv_layers) != 1:
+			print("WARNING: object '" + name + "' has multiple texture coordinate layers; only exporting '" + mesh.uv_layers.active.name + "'")
+		luv = numpy.empty(len(mesh.loops) * 2, dtype=numpy.float32)
+		mesh.uv_layers.active.data.foreach_get('uv', luv)
+
+	ply = numpy.empty(len(mesh.polygons) * 2, dtype=numpy.int32)
+	starts = numpy.empty(len(mesh.polygons), dtype=numpy.int32)
+	totals = numpy.empty(len(mesh.polygons), dtype=numpy.int32)
+	mesh.polygons.foreach_get('loop_start', starts)
+	mesh.polygons.foreach_get('loop_total', totals)
+	ply[0::2] = starts
+	ply[1::2] = totals
+
+	name_begin = len(strings)
+	strings += bytes(name, "utf8")
+	name_end = len(strings)
+
+	entries.append(struct.pack('8I',
+		name_begin, name_end,
+		vertex_count, vertex_count + len(mesh.vertices),
+		loop_count, loop_count + len(mesh.loops),
+		poly_count, poly_count + len(mesh.polygons)
+	))
+
+	positions.append(v.tobytes())
+	loop_vertices.append(lvi.astype(numpy.uint32).tobytes())
+	loop_normals.append(lnm.tobytes())
+	loop_colors.append(lcl.tobytes())
+	loop_uvs.append(luv.tobytes())
+	polys.append(ply.astype(numpy.uint32).tobytes())
+
+	vertex_count += len(mesh.vertices)
+	loop_count += len(mesh.loops)
+	poly_count += len(mesh.polygons)
+
+	evaluated.to_mesh_clear()
+
+blob = open(outfile, 'wb')
+def write_chunk(magic, data):
+	blob.write(struct.pack('4s', magic)) #type
+	blob.write(struct.pack('I', len(data))) #length
+	blob.write(data)
+
+write_chunk(b'str0', strings)
+write_chunk(b'msh0', b''.join(entries))
+write_chunk(b'pos0', b''.join(positions))
+write_chunk(b'lvi0', b''.join(loop_vertices))
+write_chunk(b'lnm0', b''.join(loop_normals))
+write_chunk(b'lcl0', b''.join(loop_colors))
+write_chunk(b'luv0', b''.join(loop_uvs))
+write_chunk(b'ply0', b''.join(polys))
+wrote = blob.tell()
+blob.close()
+
+print("Wrote " + str(wrote) + " bytes [" + str(len(entries)) + " meshes, " + str(vertex_count) + " vertices, " + str(loop_count) + " loops, " + str(poly_count) + " polygons] to '" + outfile + "'")
@@ -3,6 +3,7 @@
 #include "Load.hpp"
 #include "GL.hpp"
 #include "load_save_png.hpp"
+#include "FrameArena.hpp"
 
 #include <SDL.h>
 
@@ -176,6 +177,9 @@ int main(int argc, char **argv) {
 
 		//Wait until the recently-drawn frame is shown before doing it all again:
 		SDL_GL_SwapWindow(window);
+
+		//Release this frame's temporary allocations:
+		FrameArena::reset();
 	}
 
 